@@ -0,0 +1,414 @@
+#include "condition.h"
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "i8085.h"
+#include "mem.h"
+
+typedef struct condition_parser_s {
+  const char *p;
+  condition_t *condition;
+  int depth;
+  bool error;
+} condition_parser_t;
+
+typedef struct condition_name_s {
+  const char *name;
+  condition_reg_t reg;
+} condition_name_t;
+
+static const condition_name_t condition_names[] = {
+  {"a",      CONDITION_REG_A},
+  {"b",      CONDITION_REG_B},
+  {"c",      CONDITION_REG_C},
+  {"d",      CONDITION_REG_D},
+  {"e",      CONDITION_REG_E},
+  {"h",      CONDITION_REG_H},
+  {"l",      CONDITION_REG_L},
+  {"f",      CONDITION_REG_F},
+  {"bc",     CONDITION_REG_BC},
+  {"de",     CONDITION_REG_DE},
+  {"hl",     CONDITION_REG_HL},
+  {"sp",     CONDITION_REG_SP},
+  {"pc",     CONDITION_REG_PC},
+  {"m",      CONDITION_REG_M},
+  {"cycles", CONDITION_REG_CYCLES},
+  {"s",      CONDITION_REG_FLAG_S},
+  {"z",      CONDITION_REG_FLAG_Z},
+  {"ac",     CONDITION_REG_FLAG_AC},
+  {"p",      CONDITION_REG_FLAG_P},
+  {"cy",     CONDITION_REG_FLAG_CY},
+  {NULL,     0},
+};
+
+static void condition_or(condition_parser_t *parser);
+
+
+
+static void condition_emit(condition_parser_t *parser, condition_op_t op,
+  uint64_t value)
+{
+  condition_t *c = parser->condition;
+
+  if (c->code_len >= CONDITION_CODE_MAX) {
+    parser->error = true;
+    return;
+  }
+  c->code[c->code_len].op = op;
+  c->code[c->code_len].value = value;
+  c->code_len++;
+
+  /* Track the stack depth so evaluation needs no bounds checks. */
+  if (op == CONDITION_OP_CONST || op == CONDITION_OP_REG) {
+    parser->depth++;
+    if (parser->depth > CONDITION_STACK_MAX) {
+      parser->error = true;
+    }
+  } else if (op != CONDITION_OP_MEM && op != CONDITION_OP_NOT) {
+    parser->depth--;
+  }
+}
+
+
+
+static bool condition_accept(condition_parser_t *parser, const char *token)
+{
+  size_t len = strlen(token);
+
+  while (isspace((unsigned char)*parser->p)) {
+    parser->p++;
+  }
+  if (strncasecmp(parser->p, token, len) != 0) {
+    return false;
+  }
+  /* Words must not run into a name, e.g. "and" versus "andy". */
+  if (isalpha((unsigned char)token[0]) &&
+      isalnum((unsigned char)parser->p[len])) {
+    return false;
+  }
+  /* Single operators must not match the start of a double, e.g. "&&". */
+  if (len == 1 && (token[0] == '&' || token[0] == '|' || token[0] == '=') &&
+      parser->p[1] == token[0]) {
+    return false;
+  }
+  if (len == 1 && (token[0] == '<' || token[0] == '>' || token[0] == '!') &&
+      parser->p[1] == '=') {
+    return false;
+  }
+  parser->p += len;
+  return true;
+}
+
+
+
+static void condition_primary(condition_parser_t *parser)
+{
+  char name[8];
+  char *end;
+  int i;
+
+  while (isspace((unsigned char)*parser->p)) {
+    parser->p++;
+  }
+
+  if (condition_accept(parser, "(")) {
+    condition_or(parser);
+    if (! condition_accept(parser, ")")) {
+      parser->error = true;
+    }
+
+  } else if (condition_accept(parser, "[")) {
+    condition_or(parser);
+    condition_emit(parser, CONDITION_OP_MEM, 0);
+    if (! condition_accept(parser, "]")) {
+      parser->error = true;
+    }
+
+  } else if (isdigit((unsigned char)*parser->p)) {
+    /* 0x prefix for hex, decimal otherwise, also as 1e6. */
+    if (parser->p[0] == '0' && tolower((unsigned char)parser->p[1]) == 'x') {
+      condition_emit(parser, CONDITION_OP_CONST,
+        strtoull(parser->p, &end, 16));
+    } else {
+      condition_emit(parser, CONDITION_OP_CONST,
+        (uint64_t)strtod(parser->p, &end));
+    }
+    parser->p = end;
+
+  } else if (isalpha((unsigned char)*parser->p)) {
+    for (i = 0; isalpha((unsigned char)*parser->p); i++) {
+      if (i >= (int)sizeof(name) - 1) {
+        parser->error = true;
+        return;
+      }
+      name[i] = *parser->p++;
+    }
+    name[i] = '\0';
+    for (i = 0; condition_names[i].name != NULL; i++) {
+      if (strcasecmp(name, condition_names[i].name) == 0) {
+        condition_emit(parser, CONDITION_OP_REG, condition_names[i].reg);
+        return;
+      }
+    }
+    parser->error = true;
+
+  } else {
+    parser->error = true;
+  }
+}
+
+
+
+static void condition_unary(condition_parser_t *parser)
+{
+  if (condition_accept(parser, "!")) {
+    condition_unary(parser);
+    condition_emit(parser, CONDITION_OP_NOT, 0);
+  } else {
+    condition_primary(parser);
+  }
+}
+
+
+
+static void condition_add(condition_parser_t *parser)
+{
+  condition_unary(parser);
+  while (! parser->error) {
+    if (condition_accept(parser, "+")) {
+      condition_unary(parser);
+      condition_emit(parser, CONDITION_OP_ADD, 0);
+    } else if (condition_accept(parser, "-")) {
+      condition_unary(parser);
+      condition_emit(parser, CONDITION_OP_SUB, 0);
+    } else {
+      break;
+    }
+  }
+}
+
+
+
+static void condition_bits(condition_parser_t *parser)
+{
+  condition_add(parser);
+  while (! parser->error) {
+    if (condition_accept(parser, "&")) {
+      condition_add(parser);
+      condition_emit(parser, CONDITION_OP_BAND, 0);
+    } else if (condition_accept(parser, "|")) {
+      condition_add(parser);
+      condition_emit(parser, CONDITION_OP_BOR, 0);
+    } else {
+      break;
+    }
+  }
+}
+
+
+
+static void condition_compare(condition_parser_t *parser)
+{
+  condition_op_t op;
+
+  condition_bits(parser);
+  if (condition_accept(parser, "==") || condition_accept(parser, "=")) {
+    op = CONDITION_OP_EQ;
+  } else if (condition_accept(parser, "!=")) {
+    op = CONDITION_OP_NE;
+  } else if (condition_accept(parser, "<=")) {
+    op = CONDITION_OP_LE;
+  } else if (condition_accept(parser, ">=")) {
+    op = CONDITION_OP_GE;
+  } else if (condition_accept(parser, "<")) {
+    op = CONDITION_OP_LT;
+  } else if (condition_accept(parser, ">")) {
+    op = CONDITION_OP_GT;
+  } else {
+    return;
+  }
+  condition_bits(parser);
+  condition_emit(parser, op, 0);
+}
+
+
+
+static void condition_and(condition_parser_t *parser)
+{
+  condition_compare(parser);
+  while (! parser->error &&
+    (condition_accept(parser, "&&") || condition_accept(parser, "and"))) {
+    condition_compare(parser);
+    condition_emit(parser, CONDITION_OP_AND, 0);
+  }
+}
+
+
+
+static void condition_or(condition_parser_t *parser)
+{
+  condition_and(parser);
+  while (! parser->error &&
+    (condition_accept(parser, "||") || condition_accept(parser, "or"))) {
+    condition_and(parser);
+    condition_emit(parser, CONDITION_OP_OR, 0);
+  }
+}
+
+
+
+int condition_compile(condition_t *condition, const char *text)
+{
+  condition_parser_t parser;
+
+  memset(condition, 0, sizeof(condition_t));
+  parser.p = text;
+  parser.condition = condition;
+  parser.depth = 0;
+  parser.error = false;
+
+  condition_or(&parser);
+  while (isspace((unsigned char)*parser.p)) {
+    parser.p++;
+  }
+  if (parser.error || *parser.p != '\0' || parser.depth != 1) {
+    return -1;
+  }
+
+  snprintf(condition->text, CONDITION_TEXT_MAX, "%s", text);
+  return 0;
+}
+
+
+
+static uint64_t condition_reg(i8085_t *cpu, mem_t *mem, uint64_t reg)
+{
+  switch (reg) {
+  case CONDITION_REG_A:
+    return cpu->a;
+  case CONDITION_REG_B:
+    return cpu->b;
+  case CONDITION_REG_C:
+    return cpu->c;
+  case CONDITION_REG_D:
+    return cpu->d;
+  case CONDITION_REG_E:
+    return cpu->e;
+  case CONDITION_REG_H:
+    return cpu->h;
+  case CONDITION_REG_L:
+    return cpu->l;
+  case CONDITION_REG_F:
+    return cpu->f;
+  case CONDITION_REG_BC:
+    return cpu->bc;
+  case CONDITION_REG_DE:
+    return cpu->de;
+  case CONDITION_REG_HL:
+    return cpu->hl;
+  case CONDITION_REG_SP:
+    return cpu->sp;
+  case CONDITION_REG_PC:
+    return cpu->pc;
+  case CONDITION_REG_M:
+    return mem_peek(mem, cpu->hl);
+  case CONDITION_REG_CYCLES:
+    return cpu->cycles;
+  case CONDITION_REG_FLAG_S:
+    return cpu->flag.s;
+  case CONDITION_REG_FLAG_Z:
+    return cpu->flag.z;
+  case CONDITION_REG_FLAG_AC:
+    return cpu->flag.ac;
+  case CONDITION_REG_FLAG_P:
+    return cpu->flag.p;
+  case CONDITION_REG_FLAG_CY:
+    return cpu->flag.cy;
+  default:
+    return 0;
+  }
+}
+
+
+
+bool condition_eval(condition_t *condition, i8085_t *cpu, mem_t *mem)
+{
+  uint64_t stack[CONDITION_STACK_MAX];
+  int sp = 0;
+  int i;
+
+  for (i = 0; i < condition->code_len; i++) {
+    switch (condition->code[i].op) {
+    case CONDITION_OP_CONST:
+      stack[sp++] = condition->code[i].value;
+      break;
+    case CONDITION_OP_REG:
+      stack[sp++] = condition_reg(cpu, mem, condition->code[i].value);
+      break;
+    case CONDITION_OP_MEM:
+      stack[sp - 1] = mem_peek(mem, stack[sp - 1]);
+      break;
+    case CONDITION_OP_NOT:
+      stack[sp - 1] = ! stack[sp - 1];
+      break;
+    case CONDITION_OP_EQ:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] == stack[sp];
+      break;
+    case CONDITION_OP_NE:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] != stack[sp];
+      break;
+    case CONDITION_OP_LT:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] < stack[sp];
+      break;
+    case CONDITION_OP_GT:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] > stack[sp];
+      break;
+    case CONDITION_OP_LE:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] <= stack[sp];
+      break;
+    case CONDITION_OP_GE:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] >= stack[sp];
+      break;
+    case CONDITION_OP_AND:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] && stack[sp];
+      break;
+    case CONDITION_OP_OR:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] || stack[sp];
+      break;
+    case CONDITION_OP_BAND:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] & stack[sp];
+      break;
+    case CONDITION_OP_BOR:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] | stack[sp];
+      break;
+    case CONDITION_OP_ADD:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] + stack[sp];
+      break;
+    case CONDITION_OP_SUB:
+      sp--;
+      stack[sp - 1] = stack[sp - 1] - stack[sp];
+      break;
+    }
+  }
+
+  return stack[0] != 0;
+}
+
+
+
@@ -0,0 +1,69 @@
+#ifndef _CONDITION_H
+#define _CONDITION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i8085.h"
+#include "mem.h"
+
+#define CONDITION_CODE_MAX 32
+#define CONDITION_STACK_MAX 16
+#define CONDITION_TEXT_MAX 80
+
+typedef enum {
+  CONDITION_OP_CONST,
+  CONDITION_OP_REG,
+  CONDITION_OP_MEM,
+  CONDITION_OP_NOT,
+  CONDITION_OP_EQ,
+  CONDITION_OP_NE,
+  CONDITION_OP_LT,
+  CONDITION_OP_GT,
+  CONDITION_OP_LE,
+  CONDITION_OP_GE,
+  CONDITION_OP_AND,
+  CONDITION_OP_OR,
+  CONDITION_OP_BAND,
+  CONDITION_OP_BOR,
+  CONDITION_OP_ADD,
+  CONDITION_OP_SUB,
+} condition_op_t;
+
+typedef enum {
+  CONDITION_REG_A,
+  CONDITION_REG_B,
+  CONDITION_REG_C,
+  CONDITION_REG_D,
+  CONDITION_REG_E,
+  CONDITION_REG_H,
+  CONDITION_REG_L,
+  CONDITION_REG_F,
+  CONDITION_REG_BC,
+  CONDITION_REG_DE,
+  CONDITION_REG_HL,
+  CONDITION_REG_SP,
+  CONDITION_REG_PC,
+  CONDITION_REG_M,
+  CONDITION_REG_CYCLES,
+  CONDITION_REG_FLAG_S,
+  CONDITION_REG_FLAG_Z,
+  CONDITION_REG_FLAG_AC,
+  CONDITION_REG_FLAG_P,
+  CONDITION_REG_FLAG_CY,
+} condition_reg_t;
+
+typedef struct condition_insn_s {
+  condition_op_t op;
+  uint64_t value; /* Constant or register. */
+} condition_insn_t;
+
+typedef struct condition_s {
+  condition_insn_t code[CONDITION_CODE_MAX];
+  int code_len;
+  char text[CONDITION_TEXT_MAX];
+} condition_t;
+
+int condition_compile(condition_t *condition, const char *text);
+bool condition_eval(condition_t *condition, i8085_t *cpu, mem_t *mem);
+
+#endif /* _CONDITION_H */
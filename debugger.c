@@ -0,0 +1,839 @@
+#include "debugger.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "condition.h"
+#include "disasm.h"
+#include "i8085.h"
+#include "mem.h"
+#include "profile.h"
+#include "sampler.h"
+
+
+
+static void debugger_help(debugger_t *debugger)
+{
+  fprintf(debugger->out, "Commands:\n"
+    "  q              - Quit\n"
+    "  h              - Help\n"
+    "  c              - Continue\n"
+    "  s              - Step\n"
+    "  run <n>        - Run n instructions.\n"
+    "  cycles <n>     - Run n cycles.\n"
+    "  finish         - Run until return from function.\n"
+    "  until <addr>   - Run until address.\n"
+    "  r              - Registers\n"
+    "  t              - Dump CPU Trace\n"
+    "  d <addr> [end] - Dump Memory\n"
+    "  u [addr] [n]   - Disassemble n instructions.\n"
+    "  sym <file>     - Load symbols, \"ADDR NAME\" per line.\n"
+    "  load <file> [addr]\n"
+    "                 - Load HEX (.hex) file, or binary file at address.\n"
+    "  save <file> <addr> <end>\n"
+    "                 - Save memory as HEX (.hex) or binary file.\n"
+    "  dump <file> [addr] [end]\n"
+    "                 - Dump Memory (all by default) to file.\n"
+    "  profile <file> - Write callgrind profile so far to file.\n"
+    "  samples <file> - Write folded stacks sampled so far to file.\n"
+    "  b <addr>       - Breakpoint at address.\n"
+    "  b <addr> if <cond>\n"
+    "                 - Conditional breakpoint, e.g.\n"
+    "                   \"hl>0x2080 && [0x20fe]==0x80\".\n"
+    "  b              - List breakpoints.\n"
+    "  bd <addr|all>  - Delete breakpoint(s).\n"
+    "  w <r|w|c> <addr> [end]\n"
+    "                 - Watch read/write/change.\n"
+    "  w              - List watchpoints.\n"
+    "  wd <addr|all>  - Delete watchpoint(s).\n");
+}
+
+
+
+static void debugger_watch_hook(void *cookie, uint16_t address, uint8_t old,
+  uint8_t value, bool write)
+{
+  debugger_t *debugger = cookie;
+  uint8_t types;
+
+  if (debugger->watch_hit) {
+    return; /* Keep the first hit until the debugger has shown it. */
+  }
+
+  /* Mirrored RAM is looked up by its canonical address, so watching
+   * 0x20C0 also catches an access through 0x21C0. */
+  types = debugger->watch_map[mem_canonical(address)];
+  if (((types & (1 << DEBUGGER_WATCH_READ)) && ! write) ||
+      ((types & (1 << DEBUGGER_WATCH_WRITE)) && write) ||
+      ((types & (1 << DEBUGGER_WATCH_CHANGE)) && write && old != value)) {
+    debugger->watch_hit = true;
+    debugger->watch_write = write;
+    debugger->watch_address = address;
+    debugger->watch_old = old;
+    debugger->watch_value = value;
+  }
+}
+
+
+
+static void debugger_watch_update(debugger_t *debugger)
+{
+  debugger_watchpoint_t *wp;
+  uint32_t address;
+  uint8_t types;
+  int i;
+
+  memset(debugger->watch_map, 0, sizeof(debugger->watch_map));
+  for (i = 0; i < debugger->watchpoint_count; i++) {
+    wp = &debugger->watchpoints[i];
+    for (address = wp->start; address <= wp->end; address++) {
+      debugger->watch_map[mem_canonical(address)] |= 1 << wp->type;
+    }
+  }
+
+  /* Every page holding a mirror of a watched address takes the slow
+   * path, the hook then sorts out the exact address. */
+  memset(debugger->mem->watch, 0, MEM_PAGES);
+  for (address = 0; address <= 0xFFFF; address++) {
+    types = debugger->watch_map[mem_canonical(address)];
+    if (types & (1 << DEBUGGER_WATCH_READ)) {
+      debugger->mem->watch[address >> 8] |= MEM_WATCH_READ;
+    }
+    if (types & ~(1 << DEBUGGER_WATCH_READ)) {
+      debugger->mem->watch[address >> 8] |= MEM_WATCH_WRITE;
+    }
+  }
+}
+
+
+
+static void debugger_watch_list(debugger_t *debugger)
+{
+  debugger_watchpoint_t *wp;
+  int i;
+
+  if (debugger->watchpoint_count == 0) {
+    fprintf(debugger->out, "No watchpoints.\n");
+    return;
+  }
+
+  for (i = 0; i < debugger->watchpoint_count; i++) {
+    wp = &debugger->watchpoints[i];
+    fprintf(debugger->out, "Watchpoint (%s) at 0x%04X-0x%04X\n",
+      (wp->type == DEBUGGER_WATCH_READ) ? "read" :
+      (wp->type == DEBUGGER_WATCH_WRITE) ? "write" : "change",
+      wp->start, wp->end);
+  }
+}
+
+
+
+static void debugger_watch_command(debugger_t *debugger, int argc,
+  char *argv[])
+{
+  debugger_watchpoint_t *wp;
+  int start;
+  int end;
+
+  if (argc < 3) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return;
+  }
+  if (debugger->watchpoint_count >= DEBUGGER_WATCHPOINTS_MAX) {
+    fprintf(debugger->out, "Too many watchpoints!\n");
+    return;
+  }
+  wp = &debugger->watchpoints[debugger->watchpoint_count];
+
+  if (strcmp(argv[1], "r") == 0) {
+    wp->type = DEBUGGER_WATCH_READ;
+  } else if (strcmp(argv[1], "w") == 0) {
+    wp->type = DEBUGGER_WATCH_WRITE;
+  } else if (strcmp(argv[1], "c") == 0) {
+    wp->type = DEBUGGER_WATCH_CHANGE;
+  } else {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+
+  if (sscanf(argv[2], "%4x", &start) != 1) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+  end = start;
+  if (argc >= 4 && sscanf(argv[3], "%4x", &end) != 1) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+  if (end < start) {
+    fprintf(debugger->out, "Invalid range!\n");
+    return;
+  }
+
+  wp->start = start;
+  wp->end = end;
+  debugger->watchpoint_count++;
+  debugger_watch_update(debugger);
+  fprintf(debugger->out, "Watchpoint at 0x%04X-0x%04X set.\n", start, end);
+}
+
+
+
+static void debugger_watch_delete(debugger_t *debugger, uint16_t start)
+{
+  int i;
+  int n = 0;
+
+  for (i = 0; i < debugger->watchpoint_count; i++) {
+    if (debugger->watchpoints[i].start != start) {
+      debugger->watchpoints[n++] = debugger->watchpoints[i];
+    }
+  }
+
+  if (n == debugger->watchpoint_count) {
+    fprintf(debugger->out, "No watchpoint at 0x%04X!\n", start);
+  } else {
+    fprintf(debugger->out, "Watchpoint at 0x%04X removed.\n", start);
+  }
+  debugger->watchpoint_count = n;
+  debugger_watch_update(debugger);
+}
+
+
+
+static void debugger_run_cancel(debugger_t *debugger)
+{
+  if (debugger->run_until >= 0 && ! debugger->run_until_kept) {
+    debugger_breakpoint_clear(debugger, debugger->run_until);
+  }
+  debugger->run = false;
+  debugger->run_steps = 0;
+  debugger->run_cycles = UINT64_MAX;
+  debugger->run_finish = false;
+  debugger->run_until = -1;
+}
+
+
+
+static bool debugger_run_finished(debugger_t *debugger, i8085_t *cpu,
+  uint16_t pc)
+{
+  uint8_t opcode;
+
+  /* Only taken calls and returns count, judged by the opcode that was
+   * executed and whether it fell through. PUSH/POP, XTHL, SPHL and
+   * LXI SP move SP without leaving the frame. */
+  opcode = mem_peek(debugger->mem, pc);
+  if (opcode == 0xCD || (opcode & 0xC7) == 0xC4 || (opcode & 0xC7) == 0xC7) {
+    if (cpu->pc != (uint16_t)(pc + i8085_opcodes[opcode].length)) {
+      debugger->run_depth++;
+    }
+  } else if (opcode == 0xC9 || (opcode & 0xC7) == 0xC0) {
+    if (cpu->pc != (uint16_t)(pc + 1)) {
+      if (debugger->run_depth > 0) {
+        debugger->run_depth--;
+      } else if (cpu->sp > debugger->run_sp) {
+        return true; /* Popped the return address of the frame. */
+      }
+    }
+  }
+  return false;
+}
+
+
+
+bool debugger_run_done(debugger_t *debugger, i8085_t *cpu, uint16_t pc)
+{
+  if (debugger->run_steps > 0 && --debugger->run_steps == 0) {
+    return true;
+  }
+  if (cpu->cycles >= debugger->run_cycles) {
+    return true;
+  }
+  if (debugger->run_finish) {
+    return debugger_run_finished(debugger, cpu, pc);
+  }
+  return false;
+}
+
+
+
+static bool debugger_run_command(debugger_t *debugger, i8085_t *cpu,
+  int argc, char *argv[])
+{
+  unsigned long long value = 0;
+  int address;
+
+  if (strcmp(argv[0], "finish") == 0) {
+    debugger->run_finish = true;
+    debugger->run_depth = 0;
+    debugger->run_sp = cpu->sp;
+    debugger->run = true;
+    return true;
+  }
+
+  if (argc < 2) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return false;
+  }
+
+  if (strcmp(argv[0], "until") == 0) {
+    if (sscanf(argv[1], "%4x", &address) != 1) {
+      fprintf(debugger->out, "Invalid argument!\n");
+      return false;
+    }
+    /* A temporary breakpoint, so the bitmap check finds it for free. */
+    debugger->run_until = address & 0xFFFF;
+    debugger->run_until_kept =
+      debugger_breakpoint_hit(debugger, debugger->run_until);
+    debugger_breakpoint_set(debugger, debugger->run_until);
+    debugger->run = true;
+    return true;
+  }
+
+  if (sscanf(argv[1], "%llu", &value) != 1 || value == 0) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return false;
+  }
+  if (strcmp(argv[0], "run") == 0) {
+    debugger->run_steps = value;
+  } else {
+    debugger->run_cycles = cpu->cycles + value;
+  }
+  debugger->run = true;
+  return true;
+}
+
+
+
+static void debugger_dump_command(debugger_t *debugger, mem_t *mem,
+  int argc, char *argv[])
+{
+  FILE *fh;
+  int start = 0x0000;
+  int end = 0xFFFF;
+
+  if (argc < 2) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return;
+  }
+  if ((argc >= 3 && sscanf(argv[2], "%4x", &start) != 1) ||
+      (argc >= 4 && sscanf(argv[3], "%4x", &end) != 1) || end < start) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+
+  fh = fopen(argv[1], "w");
+  if (fh == NULL) {
+    fprintf(debugger->out, "Unable to open file: %s\n", argv[1]);
+    return;
+  }
+  mem_dump(fh, mem, start, end);
+  fclose(fh);
+  fprintf(debugger->out, "Dumped 0x%04X-0x%04X to %s\n", start, end,
+    argv[1]);
+}
+
+
+
+static void debugger_load_command(debugger_t *debugger, mem_t *mem,
+  int argc, char *argv[])
+{
+  int address;
+
+  if (argc < 2) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return;
+  }
+
+  if (mem_hex_filename(argv[1])) {
+    if (mem_load_from_hex_file(mem, argv[1]) != 0) {
+      fprintf(debugger->out, "Error loading HEX file: %s\n", argv[1]);
+    } else {
+      fprintf(debugger->out, "Loaded %s\n", argv[1]);
+    }
+    return;
+  }
+
+  if (argc < 3) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return;
+  }
+  if (sscanf(argv[2], "%4x", &address) != 1) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+  if (mem_load_from_binary_file(mem, argv[1], address) != 0) {
+    fprintf(debugger->out, "Error loading binary file: %s\n", argv[1]);
+  } else {
+    fprintf(debugger->out, "Loaded %s at 0x%04X\n", argv[1], address);
+  }
+}
+
+
+
+static void debugger_save_command(debugger_t *debugger, mem_t *mem,
+  int argc, char *argv[])
+{
+  int start;
+  int end;
+  int result;
+
+  if (argc < 4) {
+    fprintf(debugger->out, "Missing argument!\n");
+    return;
+  }
+  if (sscanf(argv[2], "%4x", &start) != 1 ||
+      sscanf(argv[3], "%4x", &end) != 1 || end < start) {
+    fprintf(debugger->out, "Invalid argument!\n");
+    return;
+  }
+  if (mem_range_aliased(start, end)) {
+    fprintf(debugger->out, "Range repeats in the mirrored 256 byte RAM!\n");
+    return;
+  }
+
+  if (mem_hex_filename(argv[1])) {
+    result = mem_save_to_hex_file(mem, argv[1], start, end);
+  } else {
+    result = mem_save_to_binary_file(mem, argv[1], start, end);
+  }
+  if (result != 0) {
+    fprintf(debugger->out, "Error saving file: %s\n", argv[1]);
+  } else {
+    fprintf(debugger->out, "Saved 0x%04X-0x%04X to %s\n", start, end,
+      argv[1]);
+  }
+}
+
+
+
+static void debugger_registers(debugger_t *debugger, i8085_t *cpu)
+{
+  fprintf(debugger->out, "PC=%04X A=%02X BC=%04X DE=%04X HL=%04X SP=%04X "
+    "I=%02X %c%c%c%c%c %llu cycles\n",
+    cpu->pc, cpu->a, cpu->bc, cpu->de, cpu->hl, cpu->sp, cpu->im,
+    cpu->flag.s  ? 'S' : '.',
+    cpu->flag.z  ? 'Z' : '.',
+    cpu->flag.ac ? 'A' : '.',
+    cpu->flag.p  ? 'P' : '.',
+    cpu->flag.cy ? 'C' : '.',
+    (unsigned long long)cpu->cycles);
+}
+
+
+
+int debugger_files(debugger_t *debugger, const char *input,
+  const char *output)
+{
+  if (input != NULL) {
+    debugger->in = fopen(input, "r");
+    if (debugger->in == NULL) {
+      return -1;
+    }
+  }
+  if (output != NULL) {
+    debugger->out = fopen(output, "w");
+    if (debugger->out == NULL) {
+      return -1;
+    }
+    setvbuf(debugger->out, NULL, _IOLBF, 0); /* Keep it for a crash. */
+  }
+  return 0;
+}
+
+
+
+void debugger_init(debugger_t *debugger, mem_t *mem)
+{
+  memset(debugger, 0, sizeof(debugger_t));
+  debugger->in = stdin;
+  debugger->out = stdout;
+  debugger->run_cycles = UINT64_MAX;
+  debugger->run_until = -1;
+  debugger->mem = mem;
+  mem->watch_hook = debugger_watch_hook;
+  mem->watch_cookie = debugger;
+}
+
+
+
+void debugger_breakpoint_set(debugger_t *debugger, uint16_t address)
+{
+  if (! debugger_breakpoint_hit(debugger, address)) {
+    debugger->breakpoint_map[address >> 3] |= (1 << (address & 7));
+    debugger->breakpoints++;
+  }
+}
+
+
+
+static debugger_condition_t *debugger_condition_find(debugger_t *debugger,
+  uint16_t address)
+{
+  int i;
+
+  for (i = 0; i < debugger->condition_count; i++) {
+    if (debugger->conditions[i].address == address) {
+      return &debugger->conditions[i];
+    }
+  }
+  return NULL;
+}
+
+
+
+static void debugger_condition_remove(debugger_t *debugger, uint16_t address)
+{
+  debugger_condition_t *dc;
+
+  dc = debugger_condition_find(debugger, address);
+  if (dc != NULL) {
+    *dc = debugger->conditions[--debugger->condition_count];
+  }
+}
+
+
+
+static int debugger_condition_set(debugger_t *debugger, uint16_t address,
+  const char *text)
+{
+  debugger_condition_t *dc;
+  condition_t condition;
+
+  if (condition_compile(&condition, text) != 0) {
+    fprintf(debugger->out, "Invalid condition!\n");
+    return -1;
+  }
+
+  dc = debugger_condition_find(debugger, address);
+  if (dc == NULL) {
+    if (debugger->condition_count >= DEBUGGER_CONDITIONS_MAX) {
+      fprintf(debugger->out, "Too many conditional breakpoints!\n");
+      return -1;
+    }
+    dc = &debugger->conditions[debugger->condition_count++];
+  }
+  dc->address = address;
+  dc->condition = condition;
+  return 0;
+}
+
+
+
+bool debugger_breakpoint_check(debugger_t *debugger, i8085_t *cpu,
+  mem_t *mem)
+{
+  debugger_condition_t *dc;
+
+  if (cpu->pc == debugger->run_until) {
+    return true;
+  }
+
+  /* Only called when the bitmap hits, so the search is off the hot path. */
+  dc = debugger_condition_find(debugger, cpu->pc);
+  if (dc == NULL) {
+    return true;
+  }
+  return condition_eval(&dc->condition, cpu, mem);
+}
+
+
+
+bool debugger_breakpoint_clear(debugger_t *debugger, uint16_t address)
+{
+  if (! debugger_breakpoint_hit(debugger, address)) {
+    return false;
+  }
+  debugger_condition_remove(debugger, address);
+  debugger->breakpoint_map[address >> 3] &= ~(1 << (address & 7));
+  debugger->breakpoints--;
+  return true;
+}
+
+
+
+bool debugger_breakpoint_range(debugger_t *debugger, uint16_t address,
+  int len)
+{
+  int i;
+
+  if (debugger->breakpoints == 0) {
+    return false;
+  }
+  for (i = 0; i < len; i++) {
+    if (debugger_breakpoint_hit(debugger, address + i)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+
+static void debugger_breakpoint_list(debugger_t *debugger)
+{
+  int i;
+  int address;
+  debugger_condition_t *dc;
+
+  if (debugger->breakpoints == 0) {
+    fprintf(debugger->out, "No breakpoints.\n");
+    return;
+  }
+
+  /* Skip empty bytes of the map to find the set bits. */
+  for (i = 0; i < DEBUGGER_BREAKPOINT_MAP_SIZE; i++) {
+    if (debugger->breakpoint_map[i] == 0) {
+      continue;
+    }
+    for (address = i * 8; address < (i + 1) * 8; address++) {
+      if (! debugger_breakpoint_hit(debugger, address)) {
+        continue;
+      }
+      dc = debugger_condition_find(debugger, address);
+      if (dc != NULL) {
+        fprintf(debugger->out, "Breakpoint at 0x%04X if %s\n", address,
+          dc->condition.text);
+      } else {
+        fprintf(debugger->out, "Breakpoint at 0x%04X\n", address);
+      }
+    }
+  }
+}
+
+
+
+bool debugger(debugger_t *debugger, i8085_t *cpu, mem_t *mem)
+{
+  char input[128];
+  char *argv[5];
+  char *cond;
+  int argc;
+  int value1;
+  int value2;
+
+  debugger_run_cancel(debugger);
+  debugger->listing = cpu->pc;
+
+  fprintf(debugger->out, "\n");
+  if (debugger->watch_hit) {
+    if (debugger->watch_write) {
+      fprintf(debugger->out, "Watchpoint at 0x%04X written 0x%02X -> 0x%02X "
+        "by PC=0x%04X\n", debugger->watch_address, debugger->watch_old,
+        debugger->watch_value, debugger->watch_pc);
+    } else {
+      fprintf(debugger->out, "Watchpoint at 0x%04X read 0x%02X by PC=0x%04X\n",
+        debugger->watch_address, debugger->watch_value, debugger->watch_pc);
+    }
+  }
+
+  while (1) {
+    debugger->watch_hit = false;
+    fprintf(debugger->out, "\r%04hX> ", cpu->pc);
+
+    if (fgets(input, sizeof(input), debugger->in) == NULL) {
+      if (feof(debugger->in)) {
+        exit(EXIT_SUCCESS);
+      }
+      continue;
+    }
+    if (debugger->in != stdin) {
+      fprintf(debugger->out, "%s", input); /* Echo script commands. */
+    }
+
+    if ((strlen(input) > 0) && (input[strlen(input) - 1] == '\n')) {
+      input[strlen(input) - 1] = '\0'; /* Strip newline. */
+    }
+
+    /* Conditions run to the end of the line and may contain spaces. */
+    cond = strstr(input, " if ");
+    if (cond != NULL) {
+      *cond = '\0';
+      cond += 4;
+    }
+
+    argv[0] = strtok(input, " ");
+    if (argv[0] == NULL) {
+      continue;
+    }
+
+    for (argc = 1; argc < 5; argc++) {
+      argv[argc] = strtok(NULL, " ");
+      if (argv[argc] == NULL) {
+        break;
+      }
+    }
+
+    /* Full command names first, they share letters with short ones. */
+    if (strcmp(argv[0], "run") == 0 || strcmp(argv[0], "cycles") == 0 ||
+        strcmp(argv[0], "finish") == 0 || strcmp(argv[0], "until") == 0) {
+      if (debugger_run_command(debugger, cpu, argc, argv)) {
+        return false;
+      }
+
+    } else if (strcmp(argv[0], "sym") == 0) {
+      if (argc < 2) {
+        fprintf(debugger->out, "Missing argument!\n");
+      } else if (disasm_symbols_load(argv[1]) != 0) {
+        fprintf(debugger->out, "Error loading symbol file: %s\n", argv[1]);
+      } else {
+        fprintf(debugger->out, "Loaded %s\n", argv[1]);
+      }
+
+    } else if (strcmp(argv[0], "dump") == 0) {
+      debugger_dump_command(debugger, mem, argc, argv);
+
+    } else if (strcmp(argv[0], "load") == 0) {
+      debugger_load_command(debugger, mem, argc, argv);
+
+    } else if (strcmp(argv[0], "save") == 0) {
+      debugger_save_command(debugger, mem, argc, argv);
+
+    } else if (strcmp(argv[0], "profile") == 0) {
+      if (argc < 2) {
+        fprintf(debugger->out, "Missing argument!\n");
+      } else if (debugger->profile == NULL) {
+        fprintf(debugger->out, "Profiling is not enabled!\n");
+      } else if (profile_write(debugger->profile, argv[1]) != 0) {
+        fprintf(debugger->out, "Error writing profile file: %s\n", argv[1]);
+      } else {
+        fprintf(debugger->out, "Wrote %s\n", argv[1]);
+      }
+
+    } else if (strcmp(argv[0], "samples") == 0) {
+      if (argc < 2) {
+        fprintf(debugger->out, "Missing argument!\n");
+      } else if (debugger->sampler == NULL) {
+        fprintf(debugger->out, "Sampling is not enabled!\n");
+      } else if (sampler_write(debugger->sampler, argv[1]) != 0) {
+        fprintf(debugger->out, "Error writing samples file: %s\n", argv[1]);
+      } else {
+        fprintf(debugger->out, "Wrote %s\n", argv[1]);
+      }
+
+    } else if (strncmp(argv[0], "q", 1) == 0) {
+      exit(EXIT_SUCCESS);
+
+    } else if (strncmp(argv[0], "?", 1) == 0) {
+      debugger_help(debugger);
+
+    } else if (strncmp(argv[0], "h", 1) == 0) {
+      debugger_help(debugger);
+
+    } else if (strncmp(argv[0], "c", 1) == 0) {
+      return false;
+
+    } else if (strncmp(argv[0], "s", 1) == 0) {
+      return true;
+
+    } else if (strncmp(argv[0], "r", 1) == 0) {
+      debugger_registers(debugger, cpu);
+
+    } else if (strncmp(argv[0], "u", 1) == 0) {
+      value2 = DEBUGGER_LISTING_DEFAULT;
+      if (argc >= 2) {
+        if (sscanf(argv[1], "%4x", &value1) != 1) {
+          fprintf(debugger->out, "Invalid argument!\n");
+          continue;
+        }
+        debugger->listing = value1;
+      }
+      if (argc >= 3 && sscanf(argv[2], "%d", &value2) != 1) {
+        fprintf(debugger->out, "Invalid argument!\n");
+        continue;
+      }
+      /* Without an address it continues where the last listing ended. */
+      debugger->listing = disasm_listing(debugger->out, mem,
+        debugger->listing, value2);
+
+    } else if (strncmp(argv[0], "t", 1) == 0) {
+      i8085_trace_dump(debugger->out);
+
+    } else if (strncmp(argv[0], "d", 1) == 0) {
+      if (argc >= 3) {
+        sscanf(argv[1], "%4x", &value1);
+        sscanf(argv[2], "%4x", &value2);
+        mem_dump(debugger->out, mem, (uint32_t)value1, (uint32_t)value2);
+      } else if (argc >= 2) {
+        sscanf(argv[1], "%4x", &value1);
+        value2 = value1 + 0xFF;
+        if (value2 > 0xFFFF) {
+          value2 = 0xFFFF; /* Truncate */
+        }
+        mem_dump(debugger->out, mem, (uint32_t)value1, (uint32_t)value2);
+      } else {
+        fprintf(debugger->out, "Missing argument!\n");
+      }
+
+    } else if (strncmp(argv[0], "bd", 2) == 0) {
+      if (argc < 2) {
+        fprintf(debugger->out, "Missing argument!\n");
+      } else if (strcmp(argv[1], "all") == 0) {
+        memset(debugger->breakpoint_map, 0, DEBUGGER_BREAKPOINT_MAP_SIZE);
+        debugger->breakpoints = 0;
+        debugger->condition_count = 0;
+        fprintf(debugger->out, "All breakpoints removed.\n");
+      } else if (sscanf(argv[1], "%4x", &value1) == 1) {
+        if (debugger_breakpoint_clear(debugger, value1 & 0xFFFF)) {
+          fprintf(debugger->out, "Breakpoint at 0x%04X removed.\n",
+            value1 & 0xFFFF);
+        } else {
+          fprintf(debugger->out, "No breakpoint at 0x%04X!\n",
+            value1 & 0xFFFF);
+        }
+      } else {
+        fprintf(debugger->out, "Invalid argument!\n");
+      }
+
+    } else if (strncmp(argv[0], "wd", 2) == 0) {
+      if (argc < 2) {
+        fprintf(debugger->out, "Missing argument!\n");
+      } else if (strcmp(argv[1], "all") == 0) {
+        debugger->watchpoint_count = 0;
+        debugger_watch_update(debugger);
+        fprintf(debugger->out, "All watchpoints removed.\n");
+      } else if (sscanf(argv[1], "%4x", &value1) == 1) {
+        debugger_watch_delete(debugger, value1 & 0xFFFF);
+      } else {
+        fprintf(debugger->out, "Invalid argument!\n");
+      }
+
+    } else if (strncmp(argv[0], "w", 1) == 0) {
+      if (argc >= 2) {
+        debugger_watch_command(debugger, argc, argv);
+      } else {
+        debugger_watch_list(debugger);
+      }
+
+    } else if (strncmp(argv[0], "b", 1) == 0) {
+      if (argc >= 2) {
+        if (sscanf(argv[1], "%4x", &value1) == 1) {
+          value1 &= 0xFFFF;
+          if (cond != NULL) {
+            if (debugger_condition_set(debugger, value1, cond) != 0) {
+              continue;
+            }
+          } else {
+            debugger_condition_remove(debugger, value1);
+          }
+          debugger_breakpoint_set(debugger, value1);
+          fprintf(debugger->out, "Breakpoint at 0x%04X set.\n", value1);
+        } else {
+          fprintf(debugger->out, "Invalid argument!\n");
+        }
+      } else {
+        debugger_breakpoint_list(debugger);
+      }
+
+    } else {
+      fprintf(debugger->out, "Unknown command: '%c' (use 'h' for help.)\n",
+        argv[0][0]);
+    }
+  }
+}
+
+
+
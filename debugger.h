@@ -0,0 +1,86 @@
+#ifndef _DEBUGGER_H
+#define _DEBUGGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "condition.h"
+#include "i8085.h"
+#include "mem.h"
+#include "profile.h"
+#include "sampler.h"
+
+/* One bit per address in the 64K address space. */
+#define DEBUGGER_BREAKPOINT_MAP_SIZE (0x10000 / 8)
+
+#define DEBUGGER_WATCHPOINTS_MAX 16
+#define DEBUGGER_CONDITIONS_MAX 16
+#define DEBUGGER_LISTING_DEFAULT 16
+
+typedef enum {
+  DEBUGGER_WATCH_READ,
+  DEBUGGER_WATCH_WRITE,
+  DEBUGGER_WATCH_CHANGE,
+} debugger_watch_type_t;
+
+typedef struct debugger_watchpoint_s {
+  uint16_t start;
+  uint16_t end;
+  debugger_watch_type_t type;
+} debugger_watchpoint_t;
+
+typedef struct debugger_condition_s {
+  uint16_t address;
+  condition_t condition;
+} debugger_condition_t;
+
+typedef struct debugger_s {
+  uint8_t breakpoint_map[DEBUGGER_BREAKPOINT_MAP_SIZE];
+  unsigned int breakpoints;
+  debugger_condition_t conditions[DEBUGGER_CONDITIONS_MAX];
+  int condition_count;
+  debugger_watchpoint_t watchpoints[DEBUGGER_WATCHPOINTS_MAX];
+  int watchpoint_count;
+  uint8_t watch_map[0x10000]; /* Watch types by canonical address. */
+  bool watch_hit;
+  bool watch_write;
+  uint16_t watch_address;
+  uint16_t watch_pc; /* Set by the caller when a hit is seen. */
+  uint8_t watch_old;
+  uint8_t watch_value;
+  bool run; /* One of the run targets below is active. */
+  uint64_t run_steps;
+  uint64_t run_cycles;
+  bool run_finish;
+  int run_depth; /* Calls made since "finish", not yet returned. */
+  uint16_t run_sp; /* At "finish", at or below the return address. */
+  int32_t run_until;
+  bool run_until_kept;
+  uint16_t listing; /* Next address to disassemble. */
+  mem_t *mem;
+  profile_t *profile; /* NULL unless profiling. */
+  sampler_t *sampler; /* NULL unless sampling. */
+  FILE *in;
+  FILE *out;
+} debugger_t;
+
+void debugger_init(debugger_t *debugger, mem_t *mem);
+int debugger_files(debugger_t *debugger, const char *input,
+  const char *output);
+void debugger_breakpoint_set(debugger_t *debugger, uint16_t address);
+bool debugger_breakpoint_clear(debugger_t *debugger, uint16_t address);
+bool debugger_breakpoint_check(debugger_t *debugger, i8085_t *cpu,
+  mem_t *mem);
+bool debugger_breakpoint_range(debugger_t *debugger, uint16_t address,
+  int len);
+bool debugger_run_done(debugger_t *debugger, i8085_t *cpu, uint16_t pc);
+bool debugger(debugger_t *debugger, i8085_t *cpu, mem_t *mem);
+
+/* Checked after every instruction, so kept to a single bit test. */
+static inline bool debugger_breakpoint_hit(debugger_t *debugger,
+  uint16_t address)
+{
+  return debugger->breakpoint_map[address >> 3] & (1 << (address & 7));
+}
+
+#endif /* _DEBUGGER_H */
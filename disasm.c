@@ -0,0 +1,202 @@
+#include "disasm.h"
+#include <ctype.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i8085.h"
+#include "mem.h"
+
+typedef struct disasm_symbol_s {
+  uint16_t address;
+  char name[DISASM_SYMBOL_NAME_MAX];
+} disasm_symbol_t;
+
+static disasm_symbol_t disasm_symbols[DISASM_SYMBOLS_MAX];
+static int disasm_symbol_count = 0;
+
+
+
+int disasm_bytes(char *text, size_t size, const uint8_t *bytes)
+{
+  const i8085_opcode_t *op = &i8085_opcodes[bytes[0]];
+  const char *name;
+  uint16_t value;
+
+  if (op->mnemonic == NULL) {
+    snprintf(text, size, "DB %02XH", bytes[0]);
+    return 1;
+  }
+
+  /* The operand always comes last, so it is just appended. */
+  switch (op->length) {
+  case 2:
+    snprintf(text, size, "%s%02XH", op->mnemonic, bytes[1]);
+    break;
+  case 3:
+    value = bytes[1] + (bytes[2] * 0x100);
+    name = disasm_symbol(value);
+    if (name != NULL) {
+      snprintf(text, size, "%s%s", op->mnemonic, name);
+    } else {
+      snprintf(text, size, "%s%04XH", op->mnemonic, value);
+    }
+    break;
+  default:
+    snprintf(text, size, "%s", op->mnemonic);
+    break;
+  }
+  return op->length;
+}
+
+
+
+int disasm(char *text, size_t size, mem_t *mem, uint16_t address)
+{
+  uint8_t bytes[3];
+
+  bytes[0] = mem_peek(mem, address);
+  bytes[1] = mem_peek(mem, address + 1);
+  bytes[2] = mem_peek(mem, address + 2);
+  return disasm_bytes(text, size, bytes);
+}
+
+
+
+uint16_t disasm_listing(FILE *fh, mem_t *mem, uint16_t address, int count)
+{
+  char text[DISASM_TEXT_MAX];
+  const char *name;
+  int length;
+  int i;
+
+  while (count-- > 0) {
+    name = disasm_symbol(address);
+    if (name != NULL) {
+      fprintf(fh, "%s:\n", name);
+    }
+
+    length = disasm(text, sizeof(text), mem, address);
+    fprintf(fh, "%04X  ", address);
+    for (i = 0; i < 3; i++) {
+      if (i < length) {
+        fprintf(fh, "%02X ", mem_peek(mem, address + i));
+      } else {
+        fprintf(fh, "   ");
+      }
+    }
+    fprintf(fh, " %s\n", text);
+    address += length;
+  }
+  return address;
+}
+
+
+
+static int disasm_symbol_compare(const void *a, const void *b)
+{
+  return ((const disasm_symbol_t *)a)->address -
+    ((const disasm_symbol_t *)b)->address;
+}
+
+
+
+int disasm_symbols_load(const char *filename)
+{
+  FILE *fh;
+  char line[128];
+  char *p;
+  disasm_symbol_t *symbol;
+  unsigned int address;
+
+  fh = fopen(filename, "r");
+  if (fh == NULL) {
+    return -1;
+  }
+
+  /* One "ADDR NAME" per line, address in hex. */
+  while (fgets(line, sizeof(line), fh) != NULL) {
+    p = line;
+    while (isspace((unsigned char)*p)) {
+      p++;
+    }
+    if (*p == '\0' || *p == '#' || *p == ';') {
+      continue; /* Empty or comment. */
+    }
+    if (disasm_symbol_count >= DISASM_SYMBOLS_MAX) {
+      break;
+    }
+    symbol = &disasm_symbols[disasm_symbol_count];
+    if (sscanf(p, "%x %31s", &address, symbol->name) != 2 ||
+        address > 0xFFFF) {
+      continue;
+    }
+    symbol->address = address;
+    disasm_symbol_count++;
+  }
+
+  fclose(fh);
+
+  /* Sorted for a binary search. */
+  qsort(disasm_symbols, disasm_symbol_count, sizeof(disasm_symbol_t),
+    disasm_symbol_compare);
+  return 0;
+}
+
+
+
+static int disasm_symbol_search(uint16_t address)
+{
+  int low = 0;
+  int high = disasm_symbol_count - 1;
+  int mid;
+
+  /* Index of the first symbol at or above the address. */
+  while (low <= high) {
+    mid = (low + high) / 2;
+    if (disasm_symbols[mid].address < address) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return low;
+}
+
+
+
+const char *disasm_symbol(uint16_t address)
+{
+  int i;
+
+  i = disasm_symbol_search(address);
+  if (i < disasm_symbol_count && disasm_symbols[i].address == address) {
+    return disasm_symbols[i].name;
+  }
+  return NULL;
+}
+
+
+
+const char *disasm_symbol_nearest(uint16_t address, uint16_t *base)
+{
+  int i;
+
+  /* The symbol at the address, or else the closest one below it. */
+  i = disasm_symbol_search(address);
+  if (i >= disasm_symbol_count || disasm_symbols[i].address != address) {
+    i--;
+  }
+  if (i < 0) {
+    return NULL;
+  }
+  if (base != NULL) {
+    *base = disasm_symbols[i].address;
+  }
+  return disasm_symbols[i].name;
+}
+
+
+
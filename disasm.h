@@ -0,0 +1,20 @@
+#ifndef _DISASM_H
+#define _DISASM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "mem.h"
+
+#define DISASM_TEXT_MAX 32
+#define DISASM_SYMBOLS_MAX 4096
+#define DISASM_SYMBOL_NAME_MAX 32
+
+int disasm_bytes(char *text, size_t size, const uint8_t *bytes);
+int disasm(char *text, size_t size, mem_t *mem, uint16_t address);
+uint16_t disasm_listing(FILE *fh, mem_t *mem, uint16_t address, int count);
+int disasm_symbols_load(const char *filename);
+const char *disasm_symbol(uint16_t address);
+const char *disasm_symbol_nearest(uint16_t address, uint16_t *base);
+
+#endif /* _DISASM_H */
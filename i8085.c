@@ -4,86 +4,145 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "disasm.h"
 #include "io.h"
 #include "panic.h"
 
 
 
 #define I8085_TRACE_BUFFER_SIZE 1024
-#define I8085_TRACE_BUFFER_ENTRY 80
 
-static char i8085_trace_buffer[I8085_TRACE_BUFFER_SIZE]
-                              [I8085_TRACE_BUFFER_ENTRY];
+/* Raw state before each instruction, only formatted when dumped. */
+typedef struct i8085_trace_entry_s {
+  uint64_t cycles;
+  const char *event; /* NULL for instructions. */
+  uint16_t value; /* Event argument, if not zero. */
+  uint16_t pc;
+  uint16_t sp;
+  uint16_t bc;
+  uint16_t de;
+  uint16_t hl;
+  uint8_t a;
+  uint8_t f;
+  uint8_t im;
+  uint8_t bytes[3];
+} i8085_trace_entry_t;
+
+static i8085_trace_entry_t i8085_trace_buffer[I8085_TRACE_BUFFER_SIZE];
 static int i8085_trace_buffer_index = 0;
+static uint64_t i8085_trace_buffer_count = 0;
 
 
 
 #ifdef DISABLE_CPU_TRACE
 #define i8085_trace(...)
+#define i8085_trace_event(...)
 #else
-static void i8085_trace(i8085_t *cpu, const char *op_name,
-  const char *format, ...)
-{
-  va_list args;
-  char buffer[I8085_TRACE_BUFFER_ENTRY + 2];
-  int n = 0;
-
-  n += snprintf(&buffer[n], I8085_TRACE_BUFFER_ENTRY - n,
-    "PC=%04hX A=%02X BC=%04X DE=%04X HL=%04X SP=%04X I=%1X "
-    "%c%c%c%c%c [%06ld] ",
-    cpu->pc - 1, cpu->a, cpu->bc, cpu->de, cpu->hl, cpu->sp,
-    cpu->im & 0b1111,
-    cpu->flag.s  ? 'S' : '.',
-    cpu->flag.z  ? 'Z' : '.',
-    cpu->flag.ac ? 'A' : '.',
-    cpu->flag.p  ? 'P' : '.',
-    cpu->flag.cy ? 'C' : '.',
-    cpu->cycles);
-
-  if (op_name != NULL) {
-    n += snprintf(&buffer[n], I8085_TRACE_BUFFER_ENTRY - n, "%s ", op_name);
-  }
+static inline i8085_trace_entry_t *i8085_trace_next(i8085_t *cpu)
+{
+  i8085_trace_entry_t *entry;
 
-  if (format != NULL) {
-    va_start(args, format);
-    n += vsnprintf(&buffer[n], I8085_TRACE_BUFFER_ENTRY - n, format, args);
-    va_end(args);
-  }
+  entry = &i8085_trace_buffer[i8085_trace_buffer_index];
+  i8085_trace_buffer_index =
+    (i8085_trace_buffer_index + 1) % I8085_TRACE_BUFFER_SIZE;
+  i8085_trace_buffer_count++;
+
+  entry->cycles = cpu->cycles;
+  entry->pc = cpu->pc;
+  entry->sp = cpu->sp;
+  entry->bc = cpu->bc;
+  entry->de = cpu->de;
+  entry->hl = cpu->hl;
+  entry->a = cpu->a;
+  entry->f = cpu->f;
+  entry->im = cpu->im;
+  return entry;
+}
 
-  n += snprintf(&buffer[n], I8085_TRACE_BUFFER_ENTRY - n, "\n");
 
-  strncpy(i8085_trace_buffer[i8085_trace_buffer_index],
-    buffer, I8085_TRACE_BUFFER_ENTRY);
-  i8085_trace_buffer_index++;
-  if (i8085_trace_buffer_index >= I8085_TRACE_BUFFER_SIZE) {
-    i8085_trace_buffer_index = 0;
+
+static inline void i8085_trace(i8085_t *cpu, mem_t *mem, uint8_t opcode)
+{
+  i8085_trace_entry_t *entry;
+
+  entry = i8085_trace_next(cpu);
+  entry->pc--; /* Already past the opcode. */
+  entry->event = NULL;
+  entry->bytes[0] = opcode;
+  if (i8085_opcodes[opcode].length > 1) {
+    entry->bytes[1] = mem_peek(mem, cpu->pc);
+    entry->bytes[2] = mem_peek(mem, cpu->pc + 1);
   }
 }
+
+
+
+static void i8085_trace_event(i8085_t *cpu, const char *event,
+  uint16_t value)
+{
+  i8085_trace_entry_t *entry;
+
+  entry = i8085_trace_next(cpu);
+  entry->event = event;
+  entry->value = value;
+}
 #endif
 
 
 
 void i8085_trace_init(void)
 {
-  for (int i = 0; i < I8085_TRACE_BUFFER_SIZE; i++) {
-    i8085_trace_buffer[i][0] = '\0';
-  }
   i8085_trace_buffer_index = 0;
+  i8085_trace_buffer_count = 0;
 }
 
 
 
-void i8085_trace_dump(FILE *fh)
+static void i8085_trace_print(FILE *fh, i8085_trace_entry_t *entry)
 {
-  for (int i = i8085_trace_buffer_index; i < I8085_TRACE_BUFFER_SIZE; i++) {
-    if (i8085_trace_buffer[i][0] != '\0') {
-      fprintf(fh, i8085_trace_buffer[i]);
+  char text[DISASM_TEXT_MAX];
+  const char *name;
+
+  fprintf(fh, "PC=%04hX A=%02X BC=%04X DE=%04X HL=%04X SP=%04X I=%1X "
+    "%c%c%c%c%c [%06llu] ",
+    entry->pc, entry->a, entry->bc, entry->de, entry->hl, entry->sp,
+    entry->im & 0b1111,
+    (entry->f & 0x80) ? 'S' : '.',
+    (entry->f & 0x40) ? 'Z' : '.',
+    (entry->f & 0x10) ? 'A' : '.',
+    (entry->f & 0x04) ? 'P' : '.',
+    (entry->f & 0x01) ? 'C' : '.',
+    (unsigned long long)entry->cycles);
+
+  if (entry->event != NULL) {
+    if (entry->value != 0) {
+      fprintf(fh, "%s %u\n", entry->event, entry->value);
+    } else {
+      fprintf(fh, "%s\n", entry->event);
     }
+    return;
   }
-  for (int i = 0; i < i8085_trace_buffer_index; i++) {
-    if (i8085_trace_buffer[i][0] != '\0') {
-      fprintf(fh, i8085_trace_buffer[i]);
-    }
+
+  name = disasm_symbol(entry->pc);
+  if (name != NULL) {
+    fprintf(fh, "%s: ", name);
+  }
+  disasm_bytes(text, sizeof(text), entry->bytes);
+  fprintf(fh, "%s\n", text);
+}
+
+
+
+void i8085_trace_dump(FILE *fh)
+{
+  int i;
+  int n;
+
+  n = (i8085_trace_buffer_count < I8085_TRACE_BUFFER_SIZE) ?
+    i8085_trace_buffer_count : I8085_TRACE_BUFFER_SIZE;
+  for (i = I8085_TRACE_BUFFER_SIZE - n; i < I8085_TRACE_BUFFER_SIZE; i++) {
+    i8085_trace_print(fh, &i8085_trace_buffer[
+      (i8085_trace_buffer_index + i) % I8085_TRACE_BUFFER_SIZE]);
   }
 }
 
@@ -232,63 +291,54 @@ static inline uint8_t i8085_dcr(i8085_t *cpu, uint8_t value)
 
 static void op_aci(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "ACI", "%02XH", mem_read(mem, cpu->pc));
   i8085_adc(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_adc_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "A");
   i8085_adc(cpu, cpu->a);
 }
 
 static void op_adc_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "B");
   i8085_adc(cpu, cpu->b);
 }
 
 static void op_adc_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "C");
   i8085_adc(cpu, cpu->c);
 }
 
 static void op_adc_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "D");
   i8085_adc(cpu, cpu->d);
 }
 
 static void op_adc_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "E");
   i8085_adc(cpu, cpu->e);
 }
 
 static void op_adc_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "H");
   i8085_adc(cpu, cpu->h);
 }
 
 static void op_adc_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADC", "L");
   i8085_adc(cpu, cpu->l);
 }
 
 static void op_adc_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "ADC", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_adc(cpu, mem_read(mem, address));
@@ -297,56 +347,48 @@ static void op_adc_m(i8085_t *cpu, mem_t *mem)
 static void op_add_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "A");
   i8085_add(cpu, cpu->a);
 }
 
 static void op_add_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "B");
   i8085_add(cpu, cpu->b);
 }
 
 static void op_add_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "C");
   i8085_add(cpu, cpu->c);
 }
 
 static void op_add_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "D");
   i8085_add(cpu, cpu->d);
 }
 
 static void op_add_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "E");
   i8085_add(cpu, cpu->e);
 }
 
 static void op_add_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "H");
   i8085_add(cpu, cpu->h);
 }
 
 static void op_add_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ADD", "L");
   i8085_add(cpu, cpu->l);
 }
 
 static void op_add_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "ADD", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_add(cpu, mem_read(mem, address));
@@ -354,63 +396,54 @@ static void op_add_m(i8085_t *cpu, mem_t *mem)
 
 static void op_adi(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "ADI", "%02XH", mem_read(mem, cpu->pc));
   i8085_add(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_ana_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "A");
   i8085_ana(cpu, cpu->a);
 }
 
 static void op_ana_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "B");
   i8085_ana(cpu, cpu->b);
 }
 
 static void op_ana_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "C");
   i8085_ana(cpu, cpu->c);
 }
 
 static void op_ana_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "D");
   i8085_ana(cpu, cpu->d);
 }
 
 static void op_ana_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "E");
   i8085_ana(cpu, cpu->e);
 }
 
 static void op_ana_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "H");
   i8085_ana(cpu, cpu->h);
 }
 
 static void op_ana_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ANA", "L");
   i8085_ana(cpu, cpu->l);
 }
 
 static void op_ana_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "ANA", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_ana(cpu, mem_read(mem, address));
@@ -418,14 +451,12 @@ static void op_ana_m(i8085_t *cpu, mem_t *mem)
 
 static void op_ani(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "ANI", "%02XH", mem_read(mem, cpu->pc));
   i8085_ana(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_call(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CALL", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
@@ -436,7 +467,6 @@ static void op_call(i8085_t *cpu, mem_t *mem)
 static void op_cc(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CC", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.cy == 1) {
@@ -450,7 +480,6 @@ static void op_cc(i8085_t *cpu, mem_t *mem)
 static void op_cm(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CM", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.s == 1) {
@@ -464,70 +493,60 @@ static void op_cm(i8085_t *cpu, mem_t *mem)
 static void op_cma(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMA", "");
   cpu->a = ~cpu->a;
 }
 
 static void op_cmc(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMC", "");
   cpu->flag.cy = !cpu->flag.cy;
 }
 
 static void op_cmp_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "A");
   i8085_cmp(cpu, cpu->a);
 }
 
 static void op_cmp_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "B");
   i8085_cmp(cpu, cpu->b);
 }
 
 static void op_cmp_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "C");
   i8085_cmp(cpu, cpu->c);
 }
 
 static void op_cmp_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "D");
   i8085_cmp(cpu, cpu->d);
 }
 
 static void op_cmp_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "E");
   i8085_cmp(cpu, cpu->e);
 }
 
 static void op_cmp_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "H");
   i8085_cmp(cpu, cpu->h);
 }
 
 static void op_cmp_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "CMP", "L");
   i8085_cmp(cpu, cpu->l);
 }
 
 static void op_cmp_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CMP", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_cmp(cpu, mem_read(mem, address));
@@ -536,7 +555,6 @@ static void op_cmp_m(i8085_t *cpu, mem_t *mem)
 static void op_cnc(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CNC", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.cy == 0) {
@@ -550,7 +568,6 @@ static void op_cnc(i8085_t *cpu, mem_t *mem)
 static void op_cnz(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CNZ", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.z == 0) {
@@ -564,7 +581,6 @@ static void op_cnz(i8085_t *cpu, mem_t *mem)
 static void op_cp(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CP", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.s == 0) {
@@ -578,7 +594,6 @@ static void op_cp(i8085_t *cpu, mem_t *mem)
 static void op_cpe(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CPE", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.p == 1) {
@@ -591,14 +606,12 @@ static void op_cpe(i8085_t *cpu, mem_t *mem)
 
 static void op_cpi(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "CPI", "%02XH", mem_read(mem, cpu->pc));
   i8085_cmp(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_cpo(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CPO", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.p == 0) {
@@ -612,7 +625,6 @@ static void op_cpo(i8085_t *cpu, mem_t *mem)
 static void op_cz(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "CZ", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.z == 1) {
@@ -627,7 +639,6 @@ static void op_daa(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
   uint8_t temp;
-  i8085_trace(cpu, "DAA", "");
   temp = cpu->a;
   if (((cpu->a & 0x0F) > 9) || (cpu->flag.ac == 1)) {
     cpu->a += 0x06;
@@ -645,7 +656,6 @@ static void op_daa(i8085_t *cpu, mem_t *mem)
 static void op_dad_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DAD", "B");
   cpu->flag.cy = (uint32_t)(cpu->hl + cpu->bc) >> 16;
   cpu->hl += cpu->bc;
 }
@@ -653,7 +663,6 @@ static void op_dad_b(i8085_t *cpu, mem_t *mem)
 static void op_dad_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DAD", "D");
   cpu->flag.cy = (uint32_t)(cpu->hl + cpu->de) >> 16;
   cpu->hl += cpu->de;
 }
@@ -661,7 +670,6 @@ static void op_dad_d(i8085_t *cpu, mem_t *mem)
 static void op_dad_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DAD", "H");
   cpu->flag.cy = (uint32_t)(cpu->hl + cpu->hl) >> 16;
   cpu->hl += cpu->hl;
 }
@@ -669,7 +677,6 @@ static void op_dad_h(i8085_t *cpu, mem_t *mem)
 static void op_dad_sp(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DAD", "SP");
   cpu->flag.cy = (uint32_t)(cpu->hl + cpu->sp) >> 16;
   cpu->hl += cpu->sp;
 }
@@ -677,56 +684,48 @@ static void op_dad_sp(i8085_t *cpu, mem_t *mem)
 static void op_dcr_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "A");
   cpu->a = i8085_dcr(cpu, cpu->a);
 }
 
 static void op_dcr_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "B");
   cpu->b = i8085_dcr(cpu, cpu->b);
 }
 
 static void op_dcr_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "C");
   cpu->c = i8085_dcr(cpu, cpu->c);
 }
 
 static void op_dcr_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "D");
   cpu->d = i8085_dcr(cpu, cpu->d);
 }
 
 static void op_dcr_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "E");
   cpu->e = i8085_dcr(cpu, cpu->e);
 }
 
 static void op_dcr_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "H");
   cpu->h = i8085_dcr(cpu, cpu->h);
 }
 
 static void op_dcr_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCR", "L");
   cpu->l = i8085_dcr(cpu, cpu->l);
 }
 
 static void op_dcr_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "DCR", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, i8085_dcr(cpu, mem_read(mem, address)));
@@ -735,42 +734,36 @@ static void op_dcr_m(i8085_t *cpu, mem_t *mem)
 static void op_dcx_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCX", "B");
   cpu->bc--;
 }
 
 static void op_dcx_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCX", "D");
   cpu->de--;
 }
 
 static void op_dcx_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCX", "H");
   cpu->hl--;
 }
 
 static void op_dcx_sp(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DCX", "SP");
   cpu->sp--;
 }
 
 static void op_di(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "DI", "");
   cpu->mask.ie = 0;
 }
 
 static void op_ei(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "EI", "");
   cpu->mask.ie = 1;
 }
 
@@ -778,14 +771,12 @@ static void op_hlt(i8085_t *cpu, mem_t *mem)
 {
   (void)cpu;
   (void)mem;
-  i8085_trace(cpu, "HLT", "");
   cpu->halt = true;
 }
 
 static void op_in(i8085_t *cpu, mem_t *mem)
 {
   uint8_t port;
-  i8085_trace(cpu, "IN", "%02XH", mem_read(mem, cpu->pc));
   port = mem_read(mem, cpu->pc++);
   cpu->a = io_read(cpu->io, port);
 }
@@ -793,56 +784,48 @@ static void op_in(i8085_t *cpu, mem_t *mem)
 static void op_inr_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "A");
   cpu->a = i8085_inr(cpu, cpu->a);
 }
 
 static void op_inr_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "B");
   cpu->b = i8085_inr(cpu, cpu->b);
 }
 
 static void op_inr_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "C");
   cpu->c = i8085_inr(cpu, cpu->c);
 }
 
 static void op_inr_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "D");
   cpu->d = i8085_inr(cpu, cpu->d);
 }
 
 static void op_inr_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "E");
   cpu->e = i8085_inr(cpu, cpu->e);
 }
 
 static void op_inr_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "H");
   cpu->h = i8085_inr(cpu, cpu->h);
 }
 
 static void op_inr_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INR", "L");
   cpu->l = i8085_inr(cpu, cpu->l);
 }
 
 static void op_inr_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "INR", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, i8085_inr(cpu, mem_read(mem, address)));
@@ -851,35 +834,30 @@ static void op_inr_m(i8085_t *cpu, mem_t *mem)
 static void op_inx_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INX", "B");
   cpu->bc++;
 }
 
 static void op_inx_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INX", "D");
   cpu->de++;
 }
 
 static void op_inx_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INX", "H");
   cpu->hl++;
 }
 
 static void op_inx_sp(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "INX", "SP");
   cpu->sp++;
 }
 
 static void op_jc(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JC", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.cy == 1) {
@@ -891,7 +869,6 @@ static void op_jc(i8085_t *cpu, mem_t *mem)
 static void op_jm(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JM", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.s == 1) {
@@ -903,7 +880,6 @@ static void op_jm(i8085_t *cpu, mem_t *mem)
 static void op_jmp(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JMP", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   cpu->pc = address;
@@ -912,7 +888,6 @@ static void op_jmp(i8085_t *cpu, mem_t *mem)
 static void op_jnc(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JNC", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.cy == 0) {
@@ -924,7 +899,6 @@ static void op_jnc(i8085_t *cpu, mem_t *mem)
 static void op_jnz(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JNZ", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.z == 0) {
@@ -936,7 +910,6 @@ static void op_jnz(i8085_t *cpu, mem_t *mem)
 static void op_jp(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JP", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.s == 0) {
@@ -948,7 +921,6 @@ static void op_jp(i8085_t *cpu, mem_t *mem)
 static void op_jpe(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JPE", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.p == 1) {
@@ -960,7 +932,6 @@ static void op_jpe(i8085_t *cpu, mem_t *mem)
 static void op_jpo(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JPO", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.p == 0) {
@@ -972,7 +943,6 @@ static void op_jpo(i8085_t *cpu, mem_t *mem)
 static void op_jz(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "JZ", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   if (cpu->flag.z == 1) {
@@ -984,7 +954,6 @@ static void op_jz(i8085_t *cpu, mem_t *mem)
 static void op_lda(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "LDA", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   cpu->a = mem_read(mem, address);
@@ -993,7 +962,6 @@ static void op_lda(i8085_t *cpu, mem_t *mem)
 static void op_ldax_b(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "LDAX", "B");
   address  = cpu->c;
   address += cpu->b * 0x100;
   cpu->a = mem_read(mem, address);
@@ -1002,7 +970,6 @@ static void op_ldax_b(i8085_t *cpu, mem_t *mem)
 static void op_ldax_d(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "LDAX", "D");
   address  = cpu->e;
   address += cpu->d * 0x100;
   cpu->a = mem_read(mem, address);
@@ -1011,7 +978,6 @@ static void op_ldax_d(i8085_t *cpu, mem_t *mem)
 static void op_lhld(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "LHLD", "D");
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   cpu->l = mem_read(mem, address);
@@ -1020,28 +986,24 @@ static void op_lhld(i8085_t *cpu, mem_t *mem)
 
 static void op_lxi_b(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "LXI", "B,%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   cpu->c = mem_read(mem, cpu->pc++);
   cpu->b = mem_read(mem, cpu->pc++);
 }
 
 static void op_lxi_d(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "LXI", "D,%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   cpu->e = mem_read(mem, cpu->pc++);
   cpu->d = mem_read(mem, cpu->pc++);
 }
 
 static void op_lxi_h(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "LXI", "H,%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   cpu->l = mem_read(mem, cpu->pc++);
   cpu->h = mem_read(mem, cpu->pc++);
 }
 
 static void op_lxi_sp(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "LXI", "SP,%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   cpu->sp  = mem_read(mem, cpu->pc++);
   cpu->sp += mem_read(mem, cpu->pc++) * 0x100;
 }
@@ -1049,56 +1011,48 @@ static void op_lxi_sp(i8085_t *cpu, mem_t *mem)
 static void op_mov_a_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,A");
   cpu->a = cpu->a;
 }
 
 static void op_mov_a_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,B");
   cpu->a = cpu->b;
 }
 
 static void op_mov_a_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,C");
   cpu->a = cpu->c;
 }
 
 static void op_mov_a_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,D");
   cpu->a = cpu->d;
 }
 
 static void op_mov_a_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,E");
   cpu->a = cpu->e;
 }
 
 static void op_mov_a_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,H");
   cpu->a = cpu->h;
 }
 
 static void op_mov_a_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "A,L");
   cpu->a = cpu->l;
 }
 
 static void op_mov_a_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "A,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->a = mem_read(mem, address);
@@ -1107,56 +1061,48 @@ static void op_mov_a_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_b_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,A");
   cpu->b = cpu->a;
 }
 
 static void op_mov_b_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,B");
   cpu->b = cpu->b;
 }
 
 static void op_mov_b_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,C");
   cpu->b = cpu->c;
 }
 
 static void op_mov_b_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,D");
   cpu->b = cpu->d;
 }
 
 static void op_mov_b_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,E");
   cpu->b = cpu->e;
 }
 
 static void op_mov_b_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,H");
   cpu->b = cpu->h;
 }
 
 static void op_mov_b_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "B,L");
   cpu->b = cpu->l;
 }
 
 static void op_mov_b_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "B,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->b = mem_read(mem, address);
@@ -1165,56 +1111,48 @@ static void op_mov_b_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_c_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,A");
   cpu->c = cpu->a;
 }
 
 static void op_mov_c_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,B");
   cpu->c = cpu->b;
 }
 
 static void op_mov_c_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,C");
   cpu->c = cpu->c;
 }
 
 static void op_mov_c_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,D");
   cpu->c = cpu->d;
 }
 
 static void op_mov_c_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,E");
   cpu->c = cpu->e;
 }
 
 static void op_mov_c_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,H");
   cpu->c = cpu->h;
 }
 
 static void op_mov_c_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "C,L");
   cpu->c = cpu->l;
 }
 
 static void op_mov_c_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "C,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->c = mem_read(mem, address);
@@ -1223,56 +1161,48 @@ static void op_mov_c_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_d_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,A");
   cpu->d = cpu->a;
 }
 
 static void op_mov_d_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,B");
   cpu->d = cpu->b;
 }
 
 static void op_mov_d_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,C");
   cpu->d = cpu->c;
 }
 
 static void op_mov_d_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,D");
   cpu->d = cpu->d;
 }
 
 static void op_mov_d_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,E");
   cpu->d = cpu->e;
 }
 
 static void op_mov_d_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,H");
   cpu->d = cpu->h;
 }
 
 static void op_mov_d_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "D,L");
   cpu->d = cpu->l;
 }
 
 static void op_mov_d_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "D,H");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->d = mem_read(mem, address);
@@ -1281,56 +1211,48 @@ static void op_mov_d_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_e_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,A");
   cpu->e = cpu->a;
 }
 
 static void op_mov_e_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,B");
   cpu->e = cpu->b;
 }
 
 static void op_mov_e_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,C");
   cpu->e = cpu->c;
 }
 
 static void op_mov_e_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,D");
   cpu->e = cpu->d;
 }
 
 static void op_mov_e_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,E");
   cpu->e = cpu->e;
 }
 
 static void op_mov_e_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,H");
   cpu->e = cpu->h;
 }
 
 static void op_mov_e_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "E,L");
   cpu->e = cpu->l;
 }
 
 static void op_mov_e_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "E,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->e = mem_read(mem, address);
@@ -1339,56 +1261,48 @@ static void op_mov_e_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_h_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,A");
   cpu->h = cpu->a;
 }
 
 static void op_mov_h_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,B");
   cpu->h = cpu->b;
 }
 
 static void op_mov_h_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,C");
   cpu->h = cpu->c;
 }
 
 static void op_mov_h_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,D");
   cpu->h = cpu->d;
 }
 
 static void op_mov_h_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,E");
   cpu->h = cpu->e;
 }
 
 static void op_mov_h_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,H");
   cpu->h = cpu->h;
 }
 
 static void op_mov_h_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "H,L");
   cpu->h = cpu->l;
 }
 
 static void op_mov_h_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "H,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->h = mem_read(mem, address);
@@ -1397,56 +1311,48 @@ static void op_mov_h_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_l_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,A");
   cpu->l = cpu->a;
 }
 
 static void op_mov_l_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,B");
   cpu->l = cpu->b;
 }
 
 static void op_mov_l_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,C");
   cpu->l = cpu->c;
 }
 
 static void op_mov_l_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,D");
   cpu->l = cpu->d;
 }
 
 static void op_mov_l_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,E");
   cpu->l = cpu->e;
 }
 
 static void op_mov_l_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,H");
   cpu->l = cpu->h;
 }
 
 static void op_mov_l_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "MOV", "L,L");
   cpu->l = cpu->l;
 }
 
 static void op_mov_l_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "L,M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   cpu->l = mem_read(mem, address);
@@ -1455,7 +1361,6 @@ static void op_mov_l_m(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_a(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,A");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->a);
@@ -1464,7 +1369,6 @@ static void op_mov_m_a(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_b(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,B");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->b);
@@ -1473,7 +1377,6 @@ static void op_mov_m_b(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_c(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,C");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->c);
@@ -1482,7 +1385,6 @@ static void op_mov_m_c(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_d(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,D");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->d);
@@ -1491,7 +1393,6 @@ static void op_mov_m_d(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_e(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,E");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->e);
@@ -1500,7 +1401,6 @@ static void op_mov_m_e(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_h(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,H");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->h);
@@ -1509,7 +1409,6 @@ static void op_mov_m_h(i8085_t *cpu, mem_t *mem)
 static void op_mov_m_l(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MOV", "M,L");
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, cpu->l);
@@ -1517,50 +1416,42 @@ static void op_mov_m_l(i8085_t *cpu, mem_t *mem)
 
 static void op_mvi_a(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "A,%02XH", mem_read(mem, cpu->pc));
   cpu->a = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_b(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "B,%02XH", mem_read(mem, cpu->pc));
   cpu->b = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_c(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "C,%02XH", mem_read(mem, cpu->pc));
   cpu->c = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_d(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "D,%02XH", mem_read(mem, cpu->pc));
   cpu->d = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_e(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "E,%02XH", mem_read(mem, cpu->pc));
   cpu->e = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_h(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "H,%02XH", mem_read(mem, cpu->pc));
   cpu->h = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_l(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "MVI", "L,%02XH", mem_read(mem, cpu->pc));
   cpu->l = mem_read(mem, cpu->pc++);
 }
 
 static void op_mvi_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "MVI", "M,%02XH", mem_read(mem, cpu->pc));
   address  = cpu->l;
   address += cpu->h * 0x100;
   mem_write(mem, address, mem_read(mem, cpu->pc++));
@@ -1570,62 +1461,53 @@ static void op_nop(i8085_t *cpu, mem_t *mem)
 {
   (void)cpu;
   (void)mem;
-  i8085_trace(cpu, "NOP", "");
 }
 
 static void op_ora_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "A");
   i8085_ora(cpu, cpu->a);
 }
 
 static void op_ora_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "B");
   i8085_ora(cpu, cpu->b);
 }
 
 static void op_ora_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "C");
   i8085_ora(cpu, cpu->c);
 }
 
 static void op_ora_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "D");
   i8085_ora(cpu, cpu->d);
 }
 
 static void op_ora_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "E");
   i8085_ora(cpu, cpu->e);
 }
 
 static void op_ora_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "H");
   i8085_ora(cpu, cpu->h);
 }
 
 static void op_ora_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "ORA", "L");
   i8085_ora(cpu, cpu->l);
 }
 
 static void op_ora_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "ORA", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_ora(cpu, mem_read(mem, address));
@@ -1633,14 +1515,12 @@ static void op_ora_m(i8085_t *cpu, mem_t *mem)
 
 static void op_ori(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "ORI", "%02XH", mem_read(mem, cpu->pc));
   i8085_ora(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_out(i8085_t *cpu, mem_t *mem)
 {
   uint8_t port;
-  i8085_trace(cpu, "OUT", "%02XH", mem_read(mem, cpu->pc));
   port = mem_read(mem, cpu->pc++);
   io_write(cpu->io, port, cpu->a);
 }
@@ -1648,63 +1528,54 @@ static void op_out(i8085_t *cpu, mem_t *mem)
 static void op_pchl(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "PCHL", "");
   cpu->pc  = cpu->l;
   cpu->pc += cpu->h * 0x100;
 }
 
 static void op_pop_b(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "POP", "B");
   cpu->c = mem_read(mem, cpu->sp++);
   cpu->b = mem_read(mem, cpu->sp++);
 }
 
 static void op_pop_d(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "POP", "D");
   cpu->e = mem_read(mem, cpu->sp++);
   cpu->d = mem_read(mem, cpu->sp++);
 }
 
 static void op_pop_h(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "POP", "H");
   cpu->l = mem_read(mem, cpu->sp++);
   cpu->h = mem_read(mem, cpu->sp++);
 }
 
 static void op_pop_psw(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "POP", "PSW");
   cpu->f = mem_read(mem, cpu->sp++);
   cpu->a = mem_read(mem, cpu->sp++);
 }
 
 static void op_push_b(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "PUSH", "B");
   mem_write(mem, --cpu->sp, cpu->b);
   mem_write(mem, --cpu->sp, cpu->c);
 }
 
 static void op_push_d(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "PUSH", "D");
   mem_write(mem, --cpu->sp, cpu->d);
   mem_write(mem, --cpu->sp, cpu->e);
 }
 
 static void op_push_h(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "PUSH", "H");
   mem_write(mem, --cpu->sp, cpu->h);
   mem_write(mem, --cpu->sp, cpu->l);
 }
 
 static void op_push_psw(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "PUSH", "PSW");
   mem_write(mem, --cpu->sp, cpu->a);
   mem_write(mem, --cpu->sp, cpu->f);
 }
@@ -1712,7 +1583,6 @@ static void op_push_psw(i8085_t *cpu, mem_t *mem)
 static void op_ral(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "RAL", "");
   if (cpu->flag.cy) {
     cpu->flag.cy = cpu->a >> 7;
     cpu->a <<= 1;
@@ -1726,7 +1596,6 @@ static void op_ral(i8085_t *cpu, mem_t *mem)
 static void op_rar(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "RAR", "");
   if (cpu->flag.cy) {
     cpu->flag.cy = cpu->a & 1;
     cpu->a >>= 1;
@@ -1739,7 +1608,6 @@ static void op_rar(i8085_t *cpu, mem_t *mem)
 
 static void op_rc(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RC", "");
   if (cpu->flag.cy == 1) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1749,7 +1617,6 @@ static void op_rc(i8085_t *cpu, mem_t *mem)
 
 static void op_ret(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RET", "");
   cpu->pc  = mem_read(mem, cpu->sp++);
   cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
 }
@@ -1757,14 +1624,17 @@ static void op_ret(i8085_t *cpu, mem_t *mem)
 static void op_rim(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "RIM", "");
+  if (cpu->sid_read != NULL && cpu->sid != NULL) {
+    /* SID is only evaluated when actually read by the program. */
+    cpu->mask.sid = (cpu->sid_read)(cpu->sid, cpu->cycles);
+  }
+  cpu->mask.i55 = cpu->rst55_line;
   cpu->a = cpu->im;
 }
 
 static void op_rlc(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "RLC", "");
   cpu->flag.cy = cpu->a >> 7;
   if (cpu->flag.cy) {
     cpu->a <<= 1;
@@ -1776,7 +1646,6 @@ static void op_rlc(i8085_t *cpu, mem_t *mem)
 
 static void op_rm(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RM", "");
   if (cpu->flag.s == 1) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1786,7 +1655,6 @@ static void op_rm(i8085_t *cpu, mem_t *mem)
 
 static void op_rnc(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RNC", "");
   if (cpu->flag.cy == 0) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1796,7 +1664,6 @@ static void op_rnc(i8085_t *cpu, mem_t *mem)
 
 static void op_rnz(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RNZ", "");
   if (cpu->flag.z == 0) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1806,7 +1673,6 @@ static void op_rnz(i8085_t *cpu, mem_t *mem)
 
 static void op_rp(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RP", "");
   if (cpu->flag.s == 0) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1816,7 +1682,6 @@ static void op_rp(i8085_t *cpu, mem_t *mem)
 
 static void op_rpe(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RPE", "");
   if (cpu->flag.p == 1) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1826,7 +1691,6 @@ static void op_rpe(i8085_t *cpu, mem_t *mem)
 
 static void op_rpo(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RPO", "");
   if (cpu->flag.p == 0) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1837,7 +1701,6 @@ static void op_rpo(i8085_t *cpu, mem_t *mem)
 static void op_rrc(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "RRC", "");
   cpu->flag.cy = cpu->a & 1;
   if (cpu->flag.cy) {
     cpu->a >>= 1;
@@ -1849,7 +1712,6 @@ static void op_rrc(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_0(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "0");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 0 * 8;
@@ -1857,7 +1719,6 @@ static void op_rst_0(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_1(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "1");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 1 * 8;
@@ -1865,7 +1726,6 @@ static void op_rst_1(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_2(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "2");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 2 * 8;
@@ -1873,7 +1733,6 @@ static void op_rst_2(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_3(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "3");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 3 * 8;
@@ -1881,7 +1740,6 @@ static void op_rst_3(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_4(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "4");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 4 * 8;
@@ -1889,7 +1747,6 @@ static void op_rst_4(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_5(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "5");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 5 * 8;
@@ -1897,7 +1754,6 @@ static void op_rst_5(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_6(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "6");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 6 * 8;
@@ -1905,7 +1761,6 @@ static void op_rst_6(i8085_t *cpu, mem_t *mem)
 
 static void op_rst_7(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RST", "7");
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 7 * 8;
@@ -1913,7 +1768,6 @@ static void op_rst_7(i8085_t *cpu, mem_t *mem)
 
 static void op_rz(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "RZ", "");
   if (cpu->flag.z == 1) {
     cpu->pc  = mem_read(mem, cpu->sp++);
     cpu->pc += mem_read(mem, cpu->sp++) * 0x100;
@@ -1924,56 +1778,48 @@ static void op_rz(i8085_t *cpu, mem_t *mem)
 static void op_sbb_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "A");
   i8085_sbb(cpu, cpu->a);
 }
 
 static void op_sbb_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "B");
   i8085_sbb(cpu, cpu->b);
 }
 
 static void op_sbb_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "C");
   i8085_sbb(cpu, cpu->c);
 }
 
 static void op_sbb_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "D");
   i8085_sbb(cpu, cpu->d);
 }
 
 static void op_sbb_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "E");
   i8085_sbb(cpu, cpu->e);
 }
 
 static void op_sbb_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "H");
   i8085_sbb(cpu, cpu->h);
 }
 
 static void op_sbb_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SBB", "L");
   i8085_sbb(cpu, cpu->l);
 }
 
 static void op_sbb_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "SBB", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_sbb(cpu, mem_read(mem, address));
@@ -1981,14 +1827,12 @@ static void op_sbb_m(i8085_t *cpu, mem_t *mem)
 
 static void op_sbi(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "SBI", "%02XH", mem_read(mem, cpu->pc));
   i8085_sbb(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_shld(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "SHLD", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   mem_write(mem, address, cpu->l);
@@ -1998,7 +1842,6 @@ static void op_shld(i8085_t *cpu, mem_t *mem)
 static void op_sim(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SIM", "");
   if (((cpu->a >> 3) & 1) == 1) {
     cpu->mask.m55 =  cpu->a       & 1;
     cpu->mask.m65 = (cpu->a >> 1) & 1;
@@ -2012,14 +1855,12 @@ static void op_sim(i8085_t *cpu, mem_t *mem)
 static void op_sphl(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SPHL", "");
   cpu->sp = cpu->hl;
 }
 
 static void op_sta(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "STA", "%02X%02XH", mem_read(mem, cpu->pc+1), mem_read(mem, cpu->pc));
   address  = mem_read(mem, cpu->pc++);
   address += mem_read(mem, cpu->pc++) * 0x100;
   mem_write(mem, address, cpu->a);
@@ -2028,7 +1869,6 @@ static void op_sta(i8085_t *cpu, mem_t *mem)
 static void op_stax_b(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "STAX", "B");
   address  = cpu->c;
   address += cpu->b * 0x100;
   mem_write(mem, address, cpu->a);
@@ -2037,7 +1877,6 @@ static void op_stax_b(i8085_t *cpu, mem_t *mem)
 static void op_stax_d(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "STAX", "D");
   address  = cpu->e;
   address += cpu->d * 0x100;
   mem_write(mem, address, cpu->a);
@@ -2046,63 +1885,54 @@ static void op_stax_d(i8085_t *cpu, mem_t *mem)
 static void op_stc(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "STC", "");
   cpu->flag.cy = 1;
 }
 
 static void op_sub_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "A");
   i8085_sub(cpu, cpu->a);
 }
 
 static void op_sub_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "B");
   i8085_sub(cpu, cpu->b);
 }
 
 static void op_sub_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "C");
   i8085_sub(cpu, cpu->c);
 }
 
 static void op_sub_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "D");
   i8085_sub(cpu, cpu->d);
 }
 
 static void op_sub_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "E");
   i8085_sub(cpu, cpu->e);
 }
 
 static void op_sub_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "H");
   i8085_sub(cpu, cpu->h);
 }
 
 static void op_sub_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "SUB", "L");
   i8085_sub(cpu, cpu->l);
 }
 
 static void op_sub_m(i8085_t *cpu, mem_t *mem)
 {
   uint16_t address;
-  i8085_trace(cpu, "SUB", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_sub(cpu, mem_read(mem, address));
@@ -2110,7 +1940,6 @@ static void op_sub_m(i8085_t *cpu, mem_t *mem)
 
 static void op_sui(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "SUI", "%02XH", mem_read(mem, cpu->pc));
   i8085_sub(cpu, mem_read(mem, cpu->pc++));
 }
 
@@ -2118,7 +1947,6 @@ static void op_xchg(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
   uint16_t temp;
-  i8085_trace(cpu, "XCHG", "");
   temp = cpu->hl;
   cpu->hl = cpu->de;
   cpu->de = temp;
@@ -2127,49 +1955,42 @@ static void op_xchg(i8085_t *cpu, mem_t *mem)
 static void op_xra_a(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "A");
   i8085_xra(cpu, cpu->a);
 }
 
 static void op_xra_b(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "B");
   i8085_xra(cpu, cpu->b);
 }
 
 static void op_xra_c(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "C");
   i8085_xra(cpu, cpu->c);
 }
 
 static void op_xra_d(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "D");
   i8085_xra(cpu, cpu->d);
 }
 
 static void op_xra_e(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "E");
   i8085_xra(cpu, cpu->e);
 }
 
 static void op_xra_h(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "H");
   i8085_xra(cpu, cpu->h);
 }
 
 static void op_xra_l(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
-  i8085_trace(cpu, "XRA", "L");
   i8085_xra(cpu, cpu->l);
 }
 
@@ -2177,7 +1998,6 @@ static void op_xra_m(i8085_t *cpu, mem_t *mem)
 {
   (void)mem;
   uint16_t address;
-  i8085_trace(cpu, "XRA", "M");
   address  = cpu->l;
   address += cpu->h * 0x100;
   i8085_xra(cpu, mem_read(mem, address));
@@ -2185,14 +2005,12 @@ static void op_xra_m(i8085_t *cpu, mem_t *mem)
 
 static void op_xri(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "XRI", "%02XH", mem_read(mem, cpu->pc));
   i8085_xra(cpu, mem_read(mem, cpu->pc++));
 }
 
 static void op_xthl(i8085_t *cpu, mem_t *mem)
 {
   uint16_t temp;
-  i8085_trace(cpu, "XTHL", "");
   temp = cpu->hl;
   cpu->l = mem_read(mem, cpu->sp);
   cpu->h = mem_read(mem, cpu->sp+1);
@@ -2280,25 +2098,273 @@ static i8085_operation_func_t opcode_function[UINT8_MAX + 1] = {
 
 
 
-/* Actually "states" and not cycles according to the documentation: */
-static uint8_t opcode_cycles[UINT8_MAX + 1] = {
-/* -0 -1 -2 -3 -4 -5 -6 -7 -8 -9 -A -B -C -D -E -F */
-    4,10, 7, 6, 4, 4, 7, 4, 0,10, 7, 6, 4, 4, 7, 4, /* 0x0- */
-    0,10, 7, 6, 4, 4, 7, 4, 0,10, 7, 6, 4, 4, 7, 4, /* 0x1- */
-    4,10,16, 6, 4, 4, 7, 4, 0,10,16, 6, 4, 4, 7, 4, /* 0x2- */
-    4,10,13, 6,10,10,10, 4, 0,10,13, 6, 4, 4, 7, 4, /* 0x3- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x4- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x5- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x6- */
-    7, 7, 7, 7, 7, 7, 5, 7, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x7- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x8- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0x9- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0xA- */
-    4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 7, 4, /* 0xB- */
-    6,10, 7,10, 9,12, 7,12, 6,10, 7, 0, 9,18, 7,12, /* 0xC- */
-    6,10, 7,10, 9,12, 7,12, 6, 0, 7,10, 9, 0, 7,12, /* 0xD- */
-    6,10, 7,16, 9,12, 7,12, 6, 6, 7, 4, 9, 0, 7,12, /* 0xE- */
-    6,10, 7, 4, 9,12, 7,12, 6, 6, 7, 4, 9, 0, 7,12, /* 0xF- */
+/* Mnemonic with the operand of 2 and 3 byte instructions left off, length
+ * and states, which the documentation calls them, rather than cycles.
+ * Taken conditional CALL/RET/JMP add states in the handlers. */
+const i8085_opcode_t i8085_opcodes[UINT8_MAX + 1] = {
+  {"NOP",       1,  4}, /* 0x00 */
+  {"LXI B,",    3, 10}, /* 0x01 */
+  {"STAX B",    1,  7}, /* 0x02 */
+  {"INX B",     1,  6}, /* 0x03 */
+  {"INR B",     1,  4}, /* 0x04 */
+  {"DCR B",     1,  4}, /* 0x05 */
+  {"MVI B,",    2,  7}, /* 0x06 */
+  {"RLC",       1,  4}, /* 0x07 */
+  {NULL,        1,  0}, /* 0x08 */
+  {"DAD B",     1, 10}, /* 0x09 */
+  {"LDAX B",    1,  7}, /* 0x0A */
+  {"DCX B",     1,  6}, /* 0x0B */
+  {"INR C",     1,  4}, /* 0x0C */
+  {"DCR C",     1,  4}, /* 0x0D */
+  {"MVI C,",    2,  7}, /* 0x0E */
+  {"RRC",       1,  4}, /* 0x0F */
+  {NULL,        1,  0}, /* 0x10 */
+  {"LXI D,",    3, 10}, /* 0x11 */
+  {"STAX D",    1,  7}, /* 0x12 */
+  {"INX D",     1,  6}, /* 0x13 */
+  {"INR D",     1,  4}, /* 0x14 */
+  {"DCR D",     1,  4}, /* 0x15 */
+  {"MVI D,",    2,  7}, /* 0x16 */
+  {"RAL",       1,  4}, /* 0x17 */
+  {NULL,        1,  0}, /* 0x18 */
+  {"DAD D",     1, 10}, /* 0x19 */
+  {"LDAX D",    1,  7}, /* 0x1A */
+  {"DCX D",     1,  6}, /* 0x1B */
+  {"INR E",     1,  4}, /* 0x1C */
+  {"DCR E",     1,  4}, /* 0x1D */
+  {"MVI E,",    2,  7}, /* 0x1E */
+  {"RAR",       1,  4}, /* 0x1F */
+  {"RIM",       1,  4}, /* 0x20 */
+  {"LXI H,",    3, 10}, /* 0x21 */
+  {"SHLD ",     3, 16}, /* 0x22 */
+  {"INX H",     1,  6}, /* 0x23 */
+  {"INR H",     1,  4}, /* 0x24 */
+  {"DCR H",     1,  4}, /* 0x25 */
+  {"MVI H,",    2,  7}, /* 0x26 */
+  {"DAA",       1,  4}, /* 0x27 */
+  {NULL,        1,  0}, /* 0x28 */
+  {"DAD H",     1, 10}, /* 0x29 */
+  {"LHLD ",     3, 16}, /* 0x2A */
+  {"DCX H",     1,  6}, /* 0x2B */
+  {"INR L",     1,  4}, /* 0x2C */
+  {"DCR L",     1,  4}, /* 0x2D */
+  {"MVI L,",    2,  7}, /* 0x2E */
+  {"CMA",       1,  4}, /* 0x2F */
+  {"SIM",       1,  4}, /* 0x30 */
+  {"LXI SP,",   3, 10}, /* 0x31 */
+  {"STA ",      3, 13}, /* 0x32 */
+  {"INX SP",    1,  6}, /* 0x33 */
+  {"INR M",     1, 10}, /* 0x34 */
+  {"DCR M",     1, 10}, /* 0x35 */
+  {"MVI M,",    2, 10}, /* 0x36 */
+  {"STC",       1,  4}, /* 0x37 */
+  {NULL,        1,  0}, /* 0x38 */
+  {"DAD SP",    1, 10}, /* 0x39 */
+  {"LDA ",      3, 13}, /* 0x3A */
+  {"DCX SP",    1,  6}, /* 0x3B */
+  {"INR A",     1,  4}, /* 0x3C */
+  {"DCR A",     1,  4}, /* 0x3D */
+  {"MVI A,",    2,  7}, /* 0x3E */
+  {"CMC",       1,  4}, /* 0x3F */
+  {"MOV B,B",   1,  4}, /* 0x40 */
+  {"MOV B,C",   1,  4}, /* 0x41 */
+  {"MOV B,D",   1,  4}, /* 0x42 */
+  {"MOV B,E",   1,  4}, /* 0x43 */
+  {"MOV B,H",   1,  4}, /* 0x44 */
+  {"MOV B,L",   1,  4}, /* 0x45 */
+  {"MOV B,M",   1,  7}, /* 0x46 */
+  {"MOV B,A",   1,  4}, /* 0x47 */
+  {"MOV C,B",   1,  4}, /* 0x48 */
+  {"MOV C,C",   1,  4}, /* 0x49 */
+  {"MOV C,D",   1,  4}, /* 0x4A */
+  {"MOV C,E",   1,  4}, /* 0x4B */
+  {"MOV C,H",   1,  4}, /* 0x4C */
+  {"MOV C,L",   1,  4}, /* 0x4D */
+  {"MOV C,M",   1,  7}, /* 0x4E */
+  {"MOV C,A",   1,  4}, /* 0x4F */
+  {"MOV D,B",   1,  4}, /* 0x50 */
+  {"MOV D,C",   1,  4}, /* 0x51 */
+  {"MOV D,D",   1,  4}, /* 0x52 */
+  {"MOV D,E",   1,  4}, /* 0x53 */
+  {"MOV D,H",   1,  4}, /* 0x54 */
+  {"MOV D,L",   1,  4}, /* 0x55 */
+  {"MOV D,M",   1,  7}, /* 0x56 */
+  {"MOV D,A",   1,  4}, /* 0x57 */
+  {"MOV E,B",   1,  4}, /* 0x58 */
+  {"MOV E,C",   1,  4}, /* 0x59 */
+  {"MOV E,D",   1,  4}, /* 0x5A */
+  {"MOV E,E",   1,  4}, /* 0x5B */
+  {"MOV E,H",   1,  4}, /* 0x5C */
+  {"MOV E,L",   1,  4}, /* 0x5D */
+  {"MOV E,M",   1,  7}, /* 0x5E */
+  {"MOV E,A",   1,  4}, /* 0x5F */
+  {"MOV H,B",   1,  4}, /* 0x60 */
+  {"MOV H,C",   1,  4}, /* 0x61 */
+  {"MOV H,D",   1,  4}, /* 0x62 */
+  {"MOV H,E",   1,  4}, /* 0x63 */
+  {"MOV H,H",   1,  4}, /* 0x64 */
+  {"MOV H,L",   1,  4}, /* 0x65 */
+  {"MOV H,M",   1,  7}, /* 0x66 */
+  {"MOV H,A",   1,  4}, /* 0x67 */
+  {"MOV L,B",   1,  4}, /* 0x68 */
+  {"MOV L,C",   1,  4}, /* 0x69 */
+  {"MOV L,D",   1,  4}, /* 0x6A */
+  {"MOV L,E",   1,  4}, /* 0x6B */
+  {"MOV L,H",   1,  4}, /* 0x6C */
+  {"MOV L,L",   1,  4}, /* 0x6D */
+  {"MOV L,M",   1,  7}, /* 0x6E */
+  {"MOV L,A",   1,  4}, /* 0x6F */
+  {"MOV M,B",   1,  7}, /* 0x70 */
+  {"MOV M,C",   1,  7}, /* 0x71 */
+  {"MOV M,D",   1,  7}, /* 0x72 */
+  {"MOV M,E",   1,  7}, /* 0x73 */
+  {"MOV M,H",   1,  7}, /* 0x74 */
+  {"MOV M,L",   1,  7}, /* 0x75 */
+  {"HLT",       1,  5}, /* 0x76 */
+  {"MOV M,A",   1,  7}, /* 0x77 */
+  {"MOV A,B",   1,  4}, /* 0x78 */
+  {"MOV A,C",   1,  4}, /* 0x79 */
+  {"MOV A,D",   1,  4}, /* 0x7A */
+  {"MOV A,E",   1,  4}, /* 0x7B */
+  {"MOV A,H",   1,  4}, /* 0x7C */
+  {"MOV A,L",   1,  4}, /* 0x7D */
+  {"MOV A,M",   1,  7}, /* 0x7E */
+  {"MOV A,A",   1,  4}, /* 0x7F */
+  {"ADD B",     1,  4}, /* 0x80 */
+  {"ADD C",     1,  4}, /* 0x81 */
+  {"ADD D",     1,  4}, /* 0x82 */
+  {"ADD E",     1,  4}, /* 0x83 */
+  {"ADD H",     1,  4}, /* 0x84 */
+  {"ADD L",     1,  4}, /* 0x85 */
+  {"ADD M",     1,  7}, /* 0x86 */
+  {"ADD A",     1,  4}, /* 0x87 */
+  {"ADC B",     1,  4}, /* 0x88 */
+  {"ADC C",     1,  4}, /* 0x89 */
+  {"ADC D",     1,  4}, /* 0x8A */
+  {"ADC E",     1,  4}, /* 0x8B */
+  {"ADC H",     1,  4}, /* 0x8C */
+  {"ADC L",     1,  4}, /* 0x8D */
+  {"ADC M",     1,  7}, /* 0x8E */
+  {"ADC A",     1,  4}, /* 0x8F */
+  {"SUB B",     1,  4}, /* 0x90 */
+  {"SUB C",     1,  4}, /* 0x91 */
+  {"SUB D",     1,  4}, /* 0x92 */
+  {"SUB E",     1,  4}, /* 0x93 */
+  {"SUB H",     1,  4}, /* 0x94 */
+  {"SUB L",     1,  4}, /* 0x95 */
+  {"SUB M",     1,  7}, /* 0x96 */
+  {"SUB A",     1,  4}, /* 0x97 */
+  {"SBB B",     1,  4}, /* 0x98 */
+  {"SBB C",     1,  4}, /* 0x99 */
+  {"SBB D",     1,  4}, /* 0x9A */
+  {"SBB E",     1,  4}, /* 0x9B */
+  {"SBB H",     1,  4}, /* 0x9C */
+  {"SBB L",     1,  4}, /* 0x9D */
+  {"SBB M",     1,  7}, /* 0x9E */
+  {"SBB A",     1,  4}, /* 0x9F */
+  {"ANA B",     1,  4}, /* 0xA0 */
+  {"ANA C",     1,  4}, /* 0xA1 */
+  {"ANA D",     1,  4}, /* 0xA2 */
+  {"ANA E",     1,  4}, /* 0xA3 */
+  {"ANA H",     1,  4}, /* 0xA4 */
+  {"ANA L",     1,  4}, /* 0xA5 */
+  {"ANA M",     1,  7}, /* 0xA6 */
+  {"ANA A",     1,  4}, /* 0xA7 */
+  {"XRA B",     1,  4}, /* 0xA8 */
+  {"XRA C",     1,  4}, /* 0xA9 */
+  {"XRA D",     1,  4}, /* 0xAA */
+  {"XRA E",     1,  4}, /* 0xAB */
+  {"XRA H",     1,  4}, /* 0xAC */
+  {"XRA L",     1,  4}, /* 0xAD */
+  {"XRA M",     1,  7}, /* 0xAE */
+  {"XRA A",     1,  4}, /* 0xAF */
+  {"ORA B",     1,  4}, /* 0xB0 */
+  {"ORA C",     1,  4}, /* 0xB1 */
+  {"ORA D",     1,  4}, /* 0xB2 */
+  {"ORA E",     1,  4}, /* 0xB3 */
+  {"ORA H",     1,  4}, /* 0xB4 */
+  {"ORA L",     1,  4}, /* 0xB5 */
+  {"ORA M",     1,  7}, /* 0xB6 */
+  {"ORA A",     1,  4}, /* 0xB7 */
+  {"CMP B",     1,  4}, /* 0xB8 */
+  {"CMP C",     1,  4}, /* 0xB9 */
+  {"CMP D",     1,  4}, /* 0xBA */
+  {"CMP E",     1,  4}, /* 0xBB */
+  {"CMP H",     1,  4}, /* 0xBC */
+  {"CMP L",     1,  4}, /* 0xBD */
+  {"CMP M",     1,  7}, /* 0xBE */
+  {"CMP A",     1,  4}, /* 0xBF */
+  {"RNZ",       1,  6}, /* 0xC0 */
+  {"POP B",     1, 10}, /* 0xC1 */
+  {"JNZ ",      3,  7}, /* 0xC2 */
+  {"JMP ",      3, 10}, /* 0xC3 */
+  {"CNZ ",      3,  9}, /* 0xC4 */
+  {"PUSH B",    1, 12}, /* 0xC5 */
+  {"ADI ",      2,  7}, /* 0xC6 */
+  {"RST 0",     1, 12}, /* 0xC7 */
+  {"RZ",        1,  6}, /* 0xC8 */
+  {"RET",       1, 10}, /* 0xC9 */
+  {"JZ ",       3,  7}, /* 0xCA */
+  {NULL,        1,  0}, /* 0xCB */
+  {"CZ ",       3,  9}, /* 0xCC */
+  {"CALL ",     3, 18}, /* 0xCD */
+  {"ACI ",      2,  7}, /* 0xCE */
+  {"RST 1",     1, 12}, /* 0xCF */
+  {"RNC",       1,  6}, /* 0xD0 */
+  {"POP D",     1, 10}, /* 0xD1 */
+  {"JNC ",      3,  7}, /* 0xD2 */
+  {"OUT ",      2, 10}, /* 0xD3 */
+  {"CNC ",      3,  9}, /* 0xD4 */
+  {"PUSH D",    1, 12}, /* 0xD5 */
+  {"SUI ",      2,  7}, /* 0xD6 */
+  {"RST 2",     1, 12}, /* 0xD7 */
+  {"RC",        1,  6}, /* 0xD8 */
+  {NULL,        1,  0}, /* 0xD9 */
+  {"JC ",       3,  7}, /* 0xDA */
+  {"IN ",       2, 10}, /* 0xDB */
+  {"CC ",       3,  9}, /* 0xDC */
+  {NULL,        1,  0}, /* 0xDD */
+  {"SBI ",      2,  7}, /* 0xDE */
+  {"RST 3",     1, 12}, /* 0xDF */
+  {"RPO",       1,  6}, /* 0xE0 */
+  {"POP H",     1, 10}, /* 0xE1 */
+  {"JPO ",      3,  7}, /* 0xE2 */
+  {"XTHL",      1, 16}, /* 0xE3 */
+  {"CPO ",      3,  9}, /* 0xE4 */
+  {"PUSH H",    1, 12}, /* 0xE5 */
+  {"ANI ",      2,  7}, /* 0xE6 */
+  {"RST 4",     1, 12}, /* 0xE7 */
+  {"RPE",       1,  6}, /* 0xE8 */
+  {"PCHL",      1,  6}, /* 0xE9 */
+  {"JPE ",      3,  7}, /* 0xEA */
+  {"XCHG",      1,  4}, /* 0xEB */
+  {"CPE ",      3,  9}, /* 0xEC */
+  {NULL,        1,  0}, /* 0xED */
+  {"XRI ",      2,  7}, /* 0xEE */
+  {"RST 5",     1, 12}, /* 0xEF */
+  {"RP",        1,  6}, /* 0xF0 */
+  {"POP PSW",   1, 10}, /* 0xF1 */
+  {"JP ",       3,  7}, /* 0xF2 */
+  {"DI",        1,  4}, /* 0xF3 */
+  {"CP ",       3,  9}, /* 0xF4 */
+  {"PUSH PSW",  1, 12}, /* 0xF5 */
+  {"ORI ",      2,  7}, /* 0xF6 */
+  {"RST 6",     1, 12}, /* 0xF7 */
+  {"RM",        1,  6}, /* 0xF8 */
+  {"SPHL",      1,  6}, /* 0xF9 */
+  {"JM ",       3,  7}, /* 0xFA */
+  {"EI",        1,  4}, /* 0xFB */
+  {"CM ",       3,  9}, /* 0xFC */
+  {NULL,        1,  0}, /* 0xFD */
+  {"CPI ",      2,  7}, /* 0xFE */
+  {"RST 7",     1, 12}, /* 0xFF */
+};
+
+/* DCX rp and DCR r, the only opcodes i8085_skip_loop() starts a loop on. */
+const bool i8085_loop_start[UINT8_MAX + 1] = {
+  [0x0B] = true, [0x1B] = true, [0x2B] = true,
+  [0x05] = true, [0x0D] = true, [0x15] = true, [0x1D] = true,
+  [0x25] = true, [0x2D] = true, [0x3D] = true,
 };
 
 
@@ -2322,20 +2388,164 @@ void i8085_reset(i8085_t *cpu)
 void i8085_execute(i8085_t *cpu, mem_t *mem)
 {
   uint8_t opcode;
+  if (cpu->rst55_line) {
+    i8085_rst_55(cpu, mem);
+  }
   if (cpu->halt) {
     cpu->cycles++;
     return;
   }
   opcode = mem_read(mem, cpu->pc++);
-  cpu->cycles += opcode_cycles[opcode];
+  cpu->cycles += i8085_opcodes[opcode].cycles;
+  i8085_trace(cpu, mem, opcode);
   (opcode_function[opcode])(cpu, mem);
 }
 
 
 
+static uint8_t *i8085_register(i8085_t *cpu, int code)
+{
+  switch (code) {
+  case 0:
+    return &cpu->b;
+  case 1:
+    return &cpu->c;
+  case 2:
+    return &cpu->d;
+  case 3:
+    return &cpu->e;
+  case 4:
+    return &cpu->h;
+  case 5:
+    return &cpu->l;
+  case 7:
+    return &cpu->a;
+  default:
+    return NULL; /* M */
+  }
+}
+
+
+
+static uint16_t i8085_jnz_target(i8085_t *cpu, mem_t *mem, uint16_t address)
+{
+  if (mem_peek(mem, address) != 0xC2) {
+    return cpu->pc + 1; /* Never the loop start. */
+  }
+  return mem_peek(mem, address + 1) + (mem_peek(mem, address + 2) * 0x100);
+}
+
+
+
+bool i8085_skip_loop(i8085_t *cpu, mem_t *mem, uint64_t limit)
+{
+  uint8_t opcode;
+  uint8_t mov;
+  uint8_t ora;
+  uint8_t *first;
+  uint8_t *second;
+  uint8_t *r;
+  uint16_t *rp;
+  uint64_t count;
+  uint64_t skip;
+  uint64_t iteration;
+
+  if (cpu->halt || limit <= cpu->cycles) {
+    return false;
+  }
+  if (cpu->rst55_line && cpu->mask.ie && ! cpu->mask.m55) {
+    return false; /* Interrupt is about to be taken. */
+  }
+
+  opcode = mem_peek(mem, cpu->pc);
+  switch (opcode) {
+  case 0x0B: /* DCX B */
+  case 0x1B: /* DCX D */
+  case 0x2B: /* DCX H */
+    /* DCX rp; MOV A,hi; ORA lo; JNZ loop (or lo and hi swapped) */
+    if (i8085_jnz_target(cpu, mem, cpu->pc + 3) != cpu->pc) {
+      return false;
+    }
+    mov = mem_peek(mem, cpu->pc + 1);
+    ora = mem_peek(mem, cpu->pc + 2);
+    switch (opcode) {
+    case 0x0B:
+      rp = &cpu->bc;
+      break;
+    case 0x1B:
+      rp = &cpu->de;
+      break;
+    default:
+      rp = &cpu->hl;
+      break;
+    }
+    if ((mov & 0xF8) != 0x78 || (ora & 0xF8) != 0xB0 ||
+        (mov & 0x06) != ((opcode >> 3) & 0x06) ||
+        (ora & 0x06) != ((opcode >> 3) & 0x06) ||
+        (mov & 0x01) == (ora & 0x01)) {
+      return false;
+    }
+    first = i8085_register(cpu, mov & 0x07);
+    second = i8085_register(cpu, ora & 0x07);
+
+    count = (*rp == 0) ? 0x10000 : *rp;
+    iteration = i8085_opcodes[opcode].cycles + i8085_opcodes[mov].cycles +
+      i8085_opcodes[ora].cycles + i8085_opcodes[0xC2].cycles + 3;
+    skip = count - 1;
+    if (skip > (limit - cpu->cycles) / iteration) {
+      skip = (limit - cpu->cycles) / iteration;
+    }
+    if (skip == 0) {
+      return false;
+    }
+
+    /* Registers and flags end up as after the last skipped iteration. */
+    *rp -= skip;
+    cpu->a = *first;
+    i8085_ora(cpu, *second);
+    break;
+
+  case 0x05: /* DCR B */
+  case 0x0D: /* DCR C */
+  case 0x15: /* DCR D */
+  case 0x1D: /* DCR E */
+  case 0x25: /* DCR H */
+  case 0x2D: /* DCR L */
+  case 0x3D: /* DCR A */
+    /* DCR r; JNZ loop */
+    if (i8085_jnz_target(cpu, mem, cpu->pc + 1) != cpu->pc) {
+      return false;
+    }
+    r = i8085_register(cpu, (opcode >> 3) & 0x07);
+
+    count = (*r == 0) ? 0x100 : *r;
+    iteration = i8085_opcodes[opcode].cycles + i8085_opcodes[0xC2].cycles + 3;
+    skip = count - 1;
+    if (skip > (limit - cpu->cycles) / iteration) {
+      skip = (limit - cpu->cycles) / iteration;
+    }
+    if (skip == 0) {
+      return false;
+    }
+
+    *r -= skip - 1;
+    *r = i8085_dcr(cpu, *r);
+    break;
+
+  default:
+    return false;
+  }
+
+  i8085_trace_event(cpu, "SKIP", skip);
+  cpu->cycles += skip * iteration;
+  return true;
+}
+
+
+
 void i8085_trap(i8085_t *cpu, mem_t *mem)
 {
-  i8085_trace(cpu, "TRAP", "");
+  i8085_trace_event(cpu, "TRAP", 0);
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 0x0024;
@@ -2349,7 +2559,8 @@ void i8085_rst_55(i8085_t *cpu, mem_t *mem)
   if (cpu->mask.ie == 0 || cpu->mask.m55 == 1) {
     return;
   }
-  i8085_trace(cpu, "RST", "5.5");
+  i8085_trace_event(cpu, "RST 5.5", 0);
+  cpu->mask.ie = 0; /* Acknowledge disables further interrupts. */
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 0x002C;
@@ -2363,7 +2574,8 @@ void i8085_rst_65(i8085_t *cpu, mem_t *mem)
   if (cpu->mask.ie == 0 || cpu->mask.m65 == 1) {
     return;
   }
-  i8085_trace(cpu, "RST", "6.5");
+  i8085_trace_event(cpu, "RST 6.5", 0);
+  cpu->mask.ie = 0; /* Acknowledge disables further interrupts. */
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 0x0034;
@@ -2377,7 +2589,8 @@ void i8085_rst_75(i8085_t *cpu, mem_t *mem)
   if (cpu->mask.ie == 0 || cpu->mask.m75 == 1) {
     return;
   }
-  i8085_trace(cpu, "RST", "7.5");
+  i8085_trace_event(cpu, "RST 7.5", 0);
+  cpu->mask.ie = 0; /* Acknowledge disables further interrupts. */
   mem_write(mem, --cpu->sp, cpu->pc / 0x100);
   mem_write(mem, --cpu->sp, cpu->pc % 0x100);
   cpu->pc = 0x003C;
@@ -6,6 +6,22 @@
 #include "mem.h"
 #include "io.h"
 
+#define I8085_CLOCK_HZ 3072000
+
+/* Longest loop, in bytes, that i8085_skip_loop() recognizes. */
+#define I8085_LOOP_MAX 6
+
+typedef bool (*i8085_sid_hook_t)(void *, uint64_t);
+
+typedef struct i8085_opcode_s {
+  const char *mnemonic; /* NULL for undefined opcodes. */
+  uint8_t length;
+  uint8_t cycles;
+} i8085_opcode_t;
+
+extern const i8085_opcode_t i8085_opcodes[UINT8_MAX + 1];
+extern const bool i8085_loop_start[UINT8_MAX + 1];
+
 typedef struct i8085_s {
   uint16_t pc; /* Program Counter */
   uint16_t sp; /* Stack Pointer */
@@ -65,13 +81,17 @@ typedef struct i8085_s {
 
   bool sod; /* Serial Output Data */
   bool halt;
+  bool rst55_line; /* RST 5.5 is level triggered, e.g. 8279 IRQ. */
   uint64_t cycles;
   io_t *io;
+  i8085_sid_hook_t sid_read;
+  void *sid;
 } i8085_t;
 
 void i8085_init(i8085_t *cpu, io_t *io);
 void i8085_reset(i8085_t *cpu);
 void i8085_execute(i8085_t *cpu, mem_t *mem);
+bool i8085_skip_loop(i8085_t *cpu, mem_t *mem, uint64_t limit);
 void i8085_trap(i8085_t *cpu, mem_t *mem);
 void i8085_rst_55(i8085_t *cpu, mem_t *mem);
 void i8085_rst_65(i8085_t *cpu, mem_t *mem);
@@ -56,25 +56,45 @@ void i8155_init(i8155_t *i8155, io_t *io)
 
 bool i8155_execute(i8155_t *i8155, i8085_t *cpu)
 {
-  while (cpu->cycles > i8155->catchup_cycles) {
-    if (i8155->timer_running) {
-      if (i8155->timer > 0) {
-        i8155->timer--;
-      } else {
-        i8155->timer_running = false;
-        i8155->trap = true;
-        /* Hack to delay the trap by one CPU instruction. */
-        return false;
-      }
-    }
-    if (i8155->trap) {
-      i8155->trap = false;
-      return true;
+  uint64_t elapsed;
+
+  if (cpu->cycles <= i8155->catchup_cycles) {
+    return false;
+  }
+  if (i8155->trap) {
+    i8155->trap = false;
+    return true;
+  }
+
+  /* Count down all elapsed cycles at once. */
+  elapsed = cpu->cycles - i8155->catchup_cycles;
+  if (i8155->timer_running) {
+    if (elapsed > i8155->timer) {
+      i8155->catchup_cycles += i8155->timer;
+      i8155->timer = 0;
+      i8155->timer_running = false;
+      i8155->trap = true;
+      /* Hack to delay the trap by one CPU instruction. */
+      return false;
     }
-    i8155->catchup_cycles++;
+    i8155->timer -= elapsed;
   }
+  i8155->catchup_cycles = cpu->cycles;
   return false;
 }
 
 
 
+uint64_t i8155_deadline(i8155_t *i8155)
+{
+  if (i8155->trap) {
+    return i8155->catchup_cycles + 1;
+  }
+  if (i8155->timer_running) {
+    return i8155->catchup_cycles + i8155->timer + 1;
+  }
+  return UINT64_MAX;
+}
+
+
+
@@ -15,5 +15,6 @@ typedef struct i8155_s {
 
 void i8155_init(i8155_t *i8155, io_t *io);
 bool i8155_execute(i8155_t *i8155, i8085_t *cpu);
+uint64_t i8155_deadline(i8155_t *i8155);
 
 #endif /* _I8155_H */
@@ -1,191 +1,622 @@
 #include "i8279.h"
-#include <curses.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 #include "i8085.h"
 #include "mem.h"
 
-#define I8279_TIMEOUT 10
+/* Display is rendered by a separate thread at a capped frame rate. */
+#define I8279_FRAME_RATE 60
+#define I8279_FRAME_TIMEOUT (1000 / I8279_FRAME_RATE)
+
+#define I8279_SNAPSHOT_FRESH 0x4
+#define I8279_SNAPSHOT_INDEX 0x3
+
+static char i8279_glyphs[UINT8_MAX + 1]
+                        [I8279_GLYPH_HEIGHT][I8279_GLYPH_WIDTH + 1];
+
+static const int i8279_digit_x[I8279_DIGITS] = {0, 8, 16, 24, 40, 48};
+
+static char i8279_decode_table[UINT8_MAX + 1];
+
+/* Lit segments of the characters known by the decoder, the bits are
+ * a=0x10 b=0x20 c=0x40 d=0x80 e=0x01 f=0x02 g=0x04, dp is decoded apart. */
+static const struct {
+  uint8_t lit;
+  char ch;
+} i8279_decode_segments[] = {
+  {0xF3, '0'}, {0x60, '1'}, {0xB5, '2'}, {0xF4, '3'},
+  {0x66, '4'}, {0xD6, '5'}, {0xD7, '6'}, {0x70, '7'},
+  {0xF7, '8'}, {0xF6, '9'}, {0x76, '9'}, {0x77, 'A'},
+  {0xC7, 'b'}, {0x93, 'C'}, {0x85, 'c'}, {0xE5, 'd'},
+  {0x97, 'E'}, {0x17, 'F'}, {0x67, 'H'}, {0x47, 'h'},
+  {0xE1, 'J'}, {0x83, 'L'}, {0x45, 'n'}, {0xC5, 'o'},
+  {0x37, 'P'}, {0x05, 'r'}, {0x87, 't'}, {0xE3, 'U'},
+  {0xC1, 'u'}, {0xE6, 'y'}, {0x04, '-'}, {0x80, '_'},
+  {0x00, ' '},
+};
+
+static i8279_t *i8279_exit_i8279 = NULL;
+
+const i8279_text_t i8279_keyboard_text[] = {
+  {11, 0, "|RESET | VECT |  C   |  D   |  E   |  F   |"},
+  {12, 0, "|      | INTR |      |      |      |      |"},
+  {14, 0, "|SINGLE|  GO  |  8   |  9   |  A   |  B   |"},
+  {15, 0, "| STEP |      |   H  |   L  |      |      |"},
+  {17, 0, "|SUBST | EXAM |  4   |  5   |  6   |  7   |"},
+  {18, 0, "| MEM  | REG  | SPH  | SPL  | PCH  | PCL  |"},
+  {20, 0, "| NEXT | EXEC |  0   |  1   |  2   |  3   |"},
+  {21, 0, "|  ,   |  .   |      |      |      |   I  |"},
+  {0, 0, NULL},
+};
+
+const i8279_text_t i8279_help_text[] = {
+  {12, 45, " . = Execute"},
+  {13, 45, " , = Next"},
+  {14, 45, " G = Go"},
+  {15, 45, " M = Substitute Memory"},
+  {16, 45, " X = Examine Registers"},
+  {17, 45, " S = Single Step"},
+  {18, 45, " R = Reset"},
+  {19, 45, " I = Vectored Interrupt"},
+  {20, 45, " Q = Quit"},
+  {0, 0, NULL},
+};
+
+/* Headless backend only keeps the 8279 state, nothing is displayed. */
+const i8279_backend_t i8279_backend_headless = {
+  .name = "headless",
+};
+
+
+
+const i8279_backend_t *i8279_backend_find(const char *name)
+{
+  if (name == NULL || strcmp(name, "curses") == 0) {
+    return &i8279_backend_curses;
+  } else if (strcmp(name, "ansi") == 0) {
+    return &i8279_backend_ansi;
+  } else if (strcmp(name, "headless") == 0) {
+    return &i8279_backend_headless;
+  }
+  return NULL;
+}
 
 
 
-void i8279_pause(void)
+static void i8279_glyph_init(void)
 {
-  endwin();
-  timeout(-1);
+  int value;
+  int y;
+  bool seg_a;
+  bool seg_b;
+  bool seg_c;
+  bool seg_d;
+  bool seg_e;
+  bool seg_f;
+  bool seg_g;
+  bool seg_dp;
+  char (*glyph)[I8279_GLYPH_WIDTH + 1];
+
+  /* Precompute the text art for all segment patterns, a set bit is off. */
+  for (value = 0; value <= UINT8_MAX; value++) {
+    seg_e  =  value       & 1;
+    seg_f  = (value >> 1) & 1;
+    seg_g  = (value >> 2) & 1;
+    seg_dp = (value >> 3) & 1;
+    seg_a  = (value >> 4) & 1;
+    seg_b  = (value >> 5) & 1;
+    seg_c  = (value >> 6) & 1;
+    seg_d  = (value >> 7) & 1;
+
+    glyph = i8279_glyphs[value];
+    for (y = 0; y < I8279_GLYPH_HEIGHT; y++) {
+      memset(glyph[y], ' ', I8279_GLYPH_WIDTH);
+      glyph[y][I8279_GLYPH_WIDTH] = '\0';
+    }
+
+    if (! seg_a) {
+      memcpy(&glyph[0][1], "####", 4);
+    }
+    if (! seg_g) {
+      memcpy(&glyph[4][1], "####", 4);
+    }
+    if (! seg_d) {
+      memcpy(&glyph[8][1], "####", 4);
+    }
+    for (y = 1; y <= 3; y++) {
+      glyph[y][0] = seg_f ? ' ' : '#';
+      glyph[y][5] = seg_b ? ' ' : '#';
+    }
+    for (y = 5; y <= 7; y++) {
+      glyph[y][0] = seg_e ? ' ' : '#';
+      glyph[y][5] = seg_c ? ' ' : '#';
+    }
+    glyph[8][6] = seg_dp ? ' ' : '#';
+  }
 }
 
 
 
-void i8279_resume(void)
+static void i8279_decode_init(void)
 {
-  timeout(I8279_TIMEOUT);
-  refresh();
+  size_t i;
+  uint8_t value;
+
+  memset(i8279_decode_table, '?', sizeof(i8279_decode_table));
+  for (i = 0; i < sizeof(i8279_decode_segments) /
+    sizeof(i8279_decode_segments[0]); i++) {
+    value = ~i8279_decode_segments[i].lit;
+    i8279_decode_table[value] = i8279_decode_segments[i].ch;
+    i8279_decode_table[value & ~0x08] = i8279_decode_segments[i].ch;
+  }
 }
 
 
 
-static void i8279_exit(void)
+char i8279_decode(uint8_t display_ram)
 {
-  endwin();
+  return i8279_decode_table[display_ram];
 }
 
 
 
-static void i8279_draw_segment(uint8_t display_ram, int y, int x)
+size_t i8279_display_text(i8279_t *i8279, char *text)
 {
-  bool seg_a;
-  bool seg_b;
-  bool seg_c;
-  bool seg_d;
-  bool seg_e;
-  bool seg_f;
-  bool seg_g;
-  bool seg_dp;
+  int i;
+  size_t n = 0;
 
-  seg_e  =  display_ram       & 1;
-  seg_f  = (display_ram >> 1) & 1;
-  seg_g  = (display_ram >> 2) & 1;
-  seg_dp = (display_ram >> 3) & 1;
-  seg_a  = (display_ram >> 4) & 1;
-  seg_b  = (display_ram >> 5) & 1;
-  seg_c  = (display_ram >> 6) & 1;
-  seg_d  = (display_ram >> 7) & 1;
-
-  if (seg_a) {
-    mvprintw(y + 0, x + 1, "    ");
-  } else {
-    mvprintw(y + 0, x + 1, "####");
+  for (i = 0; i < I8279_DIGITS; i++) {
+    text[n++] = i8279_decode_table[i8279->display_shown[i]];
+    if ((i8279->display_shown[i] & 0x08) == 0) {
+      text[n++] = '.'; /* Decimal point lit. */
+    }
   }
+  text[n] = '\0';
+  return n;
+}
 
-  if (seg_f) {
-    mvprintw(y + 1, x + 0, " ");
-    mvprintw(y + 2, x + 0, " ");
-    mvprintw(y + 3, x + 0, " ");
+
+
+int i8279_capture(i8279_t *i8279, const char *filename, bool binary)
+{
+  if (strcmp(filename, "-") == 0) {
+    i8279->capture_fh = stdout;
   } else {
-    mvprintw(y + 1, x + 0, "#");
-    mvprintw(y + 2, x + 0, "#");
-    mvprintw(y + 3, x + 0, "#");
+    i8279->capture_fh = fopen(filename, binary ? "wb" : "w");
+    if (i8279->capture_fh == NULL) {
+      return -1;
+    }
   }
+  i8279->capture_binary = binary;
+  return 0;
+}
 
-  if (seg_b) {
-    mvprintw(y + 1, x + 5, " ");
-    mvprintw(y + 2, x + 5, " ");
-    mvprintw(y + 3, x + 5, " ");
-  } else {
-    mvprintw(y + 1, x + 5, "#");
-    mvprintw(y + 2, x + 5, "#");
-    mvprintw(y + 3, x + 5, "#");
+
+
+static void i8279_display_changed(i8279_t *i8279)
+{
+  uint8_t record[I8279_CAPTURE_RECORD_SIZE];
+  char text[I8279_TEXT_MAX];
+  uint64_t cycles;
+  int i;
+
+  cycles = (i8279->cpu != NULL) ? i8279->cpu->cycles : 0;
+
+  if (i8279->display_hook != NULL) {
+    (i8279->display_hook)(i8279->display_cookie, cycles, i8279->display_shown);
   }
 
-  if (seg_g) {
-    mvprintw(y + 4, x + 1, "    ");
+  if (i8279->capture_fh == NULL) {
+    return;
+  }
+  if (i8279->capture_binary) {
+    for (i = 0; i < 8; i++) {
+      record[i] = cycles >> (i * 8);
+    }
+    memcpy(&record[8], i8279->display_shown, I8279_DIGITS);
+    fwrite(record, sizeof(record), 1, i8279->capture_fh);
   } else {
-    mvprintw(y + 4, x + 1, "####");
+    i8279_display_text(i8279, text);
+    fprintf(i8279->capture_fh, "%llu \"%s\"\n",
+      (unsigned long long)cycles, text);
   }
+}
 
-  if (seg_e) {
-    mvprintw(y + 5, x + 0, " ");
-    mvprintw(y + 6, x + 0, " ");
-    mvprintw(y + 7, x + 0, " ");
-  } else {
-    mvprintw(y + 5, x + 0, "#");
-    mvprintw(y + 6, x + 0, "#");
-    mvprintw(y + 7, x + 0, "#");
+
+
+const char *i8279_glyph(uint8_t display_ram, int row)
+{
+  return i8279_glyphs[display_ram][row];
+}
+
+
+
+static void i8279_render(i8279_t *i8279, const uint8_t *display_ram)
+{
+  int i;
+  bool changed = false;
+
+  /* Static parts are drawn once, then only changed digits. */
+  if (! i8279->layout_drawn) {
+    (i8279->backend->draw_layout)();
+    i8279->layout_drawn = true;
+    changed = true;
   }
 
-  if (seg_c) {
-    mvprintw(y + 5, x + 5, " ");
-    mvprintw(y + 6, x + 5, " ");
-    mvprintw(y + 7, x + 5, " ");
-  } else {
-    mvprintw(y + 5, x + 5, "#");
-    mvprintw(y + 6, x + 5, "#");
-    mvprintw(y + 7, x + 5, "#");
+  /* Display the segmented LEDs: */
+  for (i = 0; i < I8279_DIGITS; i++) {
+    if (i8279->digit_drawn[i] &&
+        i8279->digit_rendered[i] == display_ram[i]) {
+      continue;
+    }
+    (i8279->backend->draw_digit)(display_ram[i], i8279_digit_x[i]);
+    i8279->digit_rendered[i] = display_ram[i];
+    i8279->digit_drawn[i] = true;
+    changed = true;
   }
 
-  if (seg_d) {
-    mvprintw(y + 8, x + 1, "    ");
-  } else {
-    mvprintw(y + 8, x + 1, "####");
+  if (changed) {
+    (i8279->backend->flush)();
   }
+}
 
-  if (seg_dp) {
-    mvprintw(y + 8, x + 6, " ");
-  } else {
-    mvprintw(y + 8, x + 6, "#");
+
+
+static void i8279_wake(int fd)
+{
+  char wake = 0;
+
+  if (write(fd, &wake, 1) == -1) {
+    /* Pipe full means a wake up is already pending. */
   }
 }
 
 
 
-void i8279_update(i8279_t *i8279)
+static void i8279_key_push(i8279_t *i8279, int ch)
 {
-  /* Display the segmented LEDs: */
-  i8279_draw_segment(i8279->display_ram[0], 0, 0);
-  i8279_draw_segment(i8279->display_ram[1], 0, 8);
-  i8279_draw_segment(i8279->display_ram[2], 0, 16);
-  i8279_draw_segment(i8279->display_ram[3], 0, 24);
-  i8279_draw_segment(i8279->display_ram[4], 0, 40);
-  i8279_draw_segment(i8279->display_ram[5], 0, 48);
-
-  /* Display the keyboard: */
-  mvprintw(11, 0, "|RESET | VECT |  C   |  D   |  E   |  F   |");
-  mvprintw(12, 0, "|      | INTR |      |      |      |      |");
-  mvprintw(14, 0, "|SINGLE|  GO  |  8   |  9   |  A   |  B   |");
-  mvprintw(15, 0, "| STEP |      |   H  |   L  |      |      |");
-  mvprintw(17, 0, "|SUBST | EXAM |  4   |  5   |  6   |  7   |");
-  mvprintw(18, 0, "| MEM  | REG  | SPH  | SPL  | PCH  | PCL  |");
-  mvprintw(20, 0, "| NEXT | EXEC |  0   |  1   |  2   |  3   |");
-  mvprintw(21, 0, "|  ,   |  .   |      |      |      |   I  |");
-  mvvline(11, 0, ACS_VLINE, 11);
-  mvvline(11, 7, ACS_VLINE, 11);
-  mvvline(11, 14, ACS_VLINE, 11);
-  mvvline(11, 21, ACS_VLINE, 11);
-  mvvline(11, 28, ACS_VLINE, 11);
-  mvvline(11, 35, ACS_VLINE, 11);
-  mvvline(11, 42, ACS_VLINE, 11);
-  mvhline(10, 0, ACS_HLINE, 43);
-  mvhline(13, 0, ACS_HLINE, 43);
-  mvhline(16, 0, ACS_HLINE, 43);
-  mvhline(19, 0, ACS_HLINE, 43);
-  mvhline(22, 0, ACS_HLINE, 43);
-
-  /* Display some helpful information: */
-  mvprintw(12, 45, " . = Execute");
-  mvprintw(13, 45, " , = Next");
-  mvprintw(14, 45, " G = Go");
-  mvprintw(15, 45, " M = Substitute Memory");
-  mvprintw(16, 45, " X = Examine Registers");
-  mvprintw(17, 45, " S = Single Step");
-  mvprintw(18, 45, " R = Reset");
-  mvprintw(19, 45, " I = Vectored Interrupt");
-  mvprintw(20, 45, " Q = Quit");
-
-  refresh();
+  unsigned int head;
+  unsigned int next;
+
+  head = atomic_load_explicit(&i8279->key_head, memory_order_relaxed);
+  next = (head + 1) % I8279_KEY_QUEUE_SIZE;
+  if (next == atomic_load_explicit(&i8279->key_tail, memory_order_acquire)) {
+    return; /* Full, drop the key. */
+  }
+  i8279->key_queue[head] = ch;
+  atomic_store_explicit(&i8279->key_head, next, memory_order_release);
+
+  /* Wake up the emulator if it is waiting for a key. */
+  i8279_wake(i8279->wake_fd[1]);
 }
 
 
 
-static void i8279_display_data_write(i8279_t *i8279, uint8_t value)
+static int i8279_key_pop(i8279_t *i8279)
+{
+  unsigned int tail;
+  int ch;
+
+  tail = atomic_load_explicit(&i8279->key_tail, memory_order_relaxed);
+  if (tail == atomic_load_explicit(&i8279->key_head, memory_order_acquire)) {
+    return I8279_HOST_KEY_NONE;
+  }
+  ch = i8279->key_queue[tail];
+  atomic_store_explicit(&i8279->key_tail,
+    (tail + 1) % I8279_KEY_QUEUE_SIZE, memory_order_release);
+  return ch;
+}
+
+
+
+static uint64_t i8279_now_ms(void)
 {
-  i8279->display_ram[i8279->display_ram_index] = value;
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+
+
+static void *i8279_render_thread(void *arg)
+{
+  i8279_t *i8279 = arg;
+  struct pollfd pfd[2];
+  sigset_t set;
+  uint64_t next_frame;
+  uint64_t now;
+  uint8_t middle;
+  char drain[16];
+  int timeout;
+  int ch;
+
+  /* SIGINT is for the emulator thread, to break into the debugger. */
+  sigemptyset(&set);
+  sigaddset(&set, SIGINT);
+  pthread_sigmask(SIG_BLOCK, &set, NULL);
+
+  /* This thread owns the backend while running, the emulator never blocks
+   * on it. It sleeps until a key arrives or a new display snapshot is
+   * published, and renders the latest snapshot at most once per frame. */
+  i8279_render(i8279, i8279->snapshot[i8279->snapshot_front]);
+  next_frame = i8279_now_ms() + I8279_FRAME_TIMEOUT;
+
+  pfd[0].fd = i8279->backend->input_fd;
+  pfd[0].events = POLLIN;
+  pfd[1].fd = i8279->render_fd[0];
+  pfd[1].events = POLLIN;
+
+  while (atomic_load(&i8279->render_running)) {
+    timeout = -1;
+    if (atomic_load(&i8279->snapshot_middle) & I8279_SNAPSHOT_FRESH) {
+      now = i8279_now_ms();
+      timeout = (now < next_frame) ? (int)(next_frame - now) : 0;
+    }
+
+    if (poll(pfd, 2, timeout) > 0) {
+      if (pfd[0].revents & POLLIN) {
+        while ((ch = (i8279->backend->key)()) != I8279_HOST_KEY_NONE) {
+          i8279_key_push(i8279, ch);
+        }
+      } else if (pfd[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+        pfd[0].fd = -1; /* Terminal is gone, stop polling it. */
+      }
+      if (pfd[1].revents & POLLIN) {
+        while (read(i8279->render_fd[0], drain, sizeof(drain)) > 0) {
+          /* Drain */
+        }
+      }
+    }
+
+    middle = atomic_load(&i8279->snapshot_middle);
+    if (middle & I8279_SNAPSHOT_FRESH) {
+      now = i8279_now_ms();
+      if (now >= next_frame) {
+        middle = atomic_exchange(&i8279->snapshot_middle,
+          i8279->snapshot_front);
+        i8279->snapshot_front = middle & I8279_SNAPSHOT_INDEX;
+        i8279_render(i8279, i8279->snapshot[i8279->snapshot_front]);
+        next_frame = now + I8279_FRAME_TIMEOUT;
+      }
+    }
+  }
+
+  return NULL;
+}
+
+
+
+void i8279_pause(i8279_t *i8279)
+{
+  if (atomic_load(&i8279->render_running)) {
+    atomic_store(&i8279->render_running, false);
+    i8279_wake(i8279->render_fd[1]);
+    pthread_join(i8279->render_thread, NULL);
+  }
+  if (i8279->backend->pause != NULL) {
+    (i8279->backend->pause)();
+  }
+}
+
+
+
+void i8279_resume(i8279_t *i8279)
+{
+  if (i8279->backend->resume != NULL) {
+    (i8279->backend->resume)();
+  }
+  if (i8279->backend->key == NULL) {
+    return; /* Headless, nothing to render. */
+  }
+
+  /* Something else may have used the terminal, so redraw everything. */
+  i8279->layout_drawn = false;
+  memset(i8279->digit_drawn, 0, sizeof(i8279->digit_drawn));
+
+  atomic_store(&i8279->render_running, true);
+  if (pthread_create(&i8279->render_thread, NULL,
+    i8279_render_thread, i8279) != 0) {
+    atomic_store(&i8279->render_running, false);
+  }
+}
+
+
+
+static void i8279_exit(void)
+{
+  if (i8279_exit_i8279 != NULL) {
+    i8279_pause(i8279_exit_i8279);
+    if (i8279_exit_i8279->capture_fh != NULL) {
+      fflush(i8279_exit_i8279->capture_fh);
+    }
+  }
+}
+
+
+
+static void i8279_irq_update(i8279_t *i8279)
+{
+  /* IRQ is high as long as the FIFO holds keys in keyboard modes. */
+  if (i8279->cpu != NULL) {
+    i8279->cpu->rst55_line = (i8279->keyboard_mode < 0b100) &&
+      (i8279->fifo_count > 0);
+  }
+}
+
+
+
+static void i8279_fifo_push(i8279_t *i8279, uint8_t value)
+{
+  if (i8279->fifo_count >= I8279_FIFO_SIZE) {
+    i8279->fifo_overrun = true;
+    i8279->fifo_overruns++;
+    return; /* Key is lost. */
+  }
+  i8279->fifo[(i8279->fifo_head + i8279->fifo_count) % I8279_FIFO_SIZE] =
+    value;
+  i8279->fifo_count++;
+  i8279_irq_update(i8279);
+}
+
+
+
+static uint8_t i8279_fifo_pop(i8279_t *i8279)
+{
+  uint8_t value;
+
+  if (i8279->fifo_count == 0) {
+    i8279->fifo_underrun = true;
+    return 0xFF;
+  }
+  value = i8279->fifo[i8279->fifo_head];
+  i8279->fifo_head = (i8279->fifo_head + 1) % I8279_FIFO_SIZE;
+  i8279->fifo_count--;
+  i8279_irq_update(i8279);
+  return value;
+}
 
+
+
+static void i8279_fifo_clear(i8279_t *i8279)
+{
+  i8279->fifo_head = 0;
+  i8279->fifo_count = 0;
+  i8279->fifo_overrun = false;
+  i8279->fifo_underrun = false;
+  i8279->sensor_ram_index = 0;
+  i8279_irq_update(i8279);
+}
+
+
+
+void i8279_update(i8279_t *i8279)
+{
+  uint8_t middle;
+  uint8_t mask = 0x00;
+  int i;
+
+  /* Blanked nibbles show the blank code instead of display RAM. */
+  if (i8279->blank_a) {
+    mask |= 0xF0;
+  }
+  if (i8279->blank_b) {
+    mask |= 0x0F;
+  }
+  for (i = 0; i < I8279_DISPLAY_RAM_MAX; i++) {
+    i8279->display_shown[i] = (i8279->display_ram[i] & ~mask) |
+      (i8279->blank_code & mask);
+  }
+
+  /* Publish a snapshot of the display to the render thread. */
+  memcpy(i8279->snapshot[i8279->snapshot_back], i8279->display_shown,
+    I8279_DISPLAY_RAM_MAX);
+  middle = atomic_exchange(&i8279->snapshot_middle,
+    i8279->snapshot_back | I8279_SNAPSHOT_FRESH);
+  i8279->snapshot_back = middle & I8279_SNAPSHOT_INDEX;
+  if (! (middle & I8279_SNAPSHOT_FRESH) &&
+      atomic_load(&i8279->render_running)) {
+    /* Previous snapshot was taken, so the render thread may be asleep. */
+    i8279_wake(i8279->render_fd[1]);
+  }
+
+  /* Report changes to the visible digits. */
+  if (memcmp(i8279->digit_last, i8279->display_shown, I8279_DIGITS) != 0) {
+    memcpy(i8279->digit_last, i8279->display_shown, I8279_DIGITS);
+    i8279_display_changed(i8279);
+  }
+}
+
+
+
+static void i8279_display_ram_next(i8279_t *i8279)
+{
   if (i8279->auto_increment) {
     i8279->display_ram_index++;
     if (i8279->display_ram_index >= i8279->display_ram_limit) {
       i8279->display_ram_index = 0;
     }
   }
+}
+
+
+
+static void i8279_display_data_write(i8279_t *i8279, uint8_t value)
+{
+  uint8_t keep = 0x00;
+
+  /* Write inhibited nibbles keep their old contents. */
+  if (i8279->inhibit_a) {
+    keep |= 0xF0;
+  }
+  if (i8279->inhibit_b) {
+    keep |= 0x0F;
+  }
+  i8279->display_ram[i8279->display_ram_index] =
+    (i8279->display_ram[i8279->display_ram_index] & keep) | (value & ~keep);
+  i8279->read_display = false;
+  i8279_display_ram_next(i8279);
 
   i8279_update(i8279);
 }
 
 
 
+static uint8_t i8279_data_read(i8279_t *i8279)
+{
+  uint8_t value;
+
+  if (i8279->read_display) {
+    value = i8279->display_ram[i8279->display_ram_index];
+    i8279_display_ram_next(i8279);
+    return value;
+  }
+
+  if (i8279->keyboard_mode >= 0b100) {
+    /* Sensor matrix or strobed input mode. */
+    value = i8279->sensor_ram[i8279->sensor_ram_index];
+    if (i8279->sensor_auto_increment) {
+      i8279->sensor_ram_index =
+        (i8279->sensor_ram_index + 1) % I8279_SENSOR_RAM_MAX;
+    }
+    return value;
+  }
+
+  return i8279_fifo_pop(i8279);
+}
+
+
+
+static uint8_t i8279_status_read(i8279_t *i8279)
+{
+  uint8_t status;
+
+  status = i8279->fifo_count & 0b111;
+  if (i8279->fifo_count >= I8279_FIFO_SIZE) {
+    status |= 0x08; /* Full */
+  }
+  if (i8279->fifo_underrun) {
+    status |= 0x10;
+  }
+  if (i8279->fifo_overrun) {
+    status |= 0x20;
+  }
+  return status;
+}
+
+
+
 static void i8279_command_word_write(i8279_t *i8279, uint8_t value)
 {
   int i;
@@ -197,35 +628,67 @@ static void i8279_command_word_write(i8279_t *i8279, uint8_t value)
     } else {
       i8279->display_ram_limit = 16;
     }
+    i8279->keyboard_mode = value & 0b111;
+    i8279_irq_update(i8279);
     break;
 
   case 0b001: /* Program Clock */
     break;
 
   case 0b010: /* Read FIFO/Sensor RAM */
+    i8279->read_display = false;
+    i8279->sensor_auto_increment = (value >> 4) & 1;
+    i8279->sensor_ram_index = value & 0b111;
     break;
 
   case 0b011: /* Read Display RAM */
+    i8279->read_display = true;
+    i8279->auto_increment = (value >> 4) & 1;
+    i8279->display_ram_index = value & 0b1111;
     break;
 
   case 0b100: /* Write Display RAM */
+    i8279->read_display = false;
     i8279->auto_increment = (value >> 4) & 1;
     i8279->display_ram_index = value & 0b1111;
     break;
 
   case 0b101: /* Display Write Inhibit/Blanking */
+    i8279->inhibit_a = (value >> 3) & 1;
+    i8279->inhibit_b = (value >> 2) & 1;
+    i8279->blank_a = (value >> 1) & 1;
+    i8279->blank_b = value & 1;
+    i8279_update(i8279);
     break;
 
   case 0b110: /* Clear */
-    for (i = 0; i < I8279_DISPLAY_RAM_MAX; i++) {
-      if (((value >> 2) & 0b11) == 0b11) {
-        i8279->display_ram[i] = 0xFF;
+    switch ((value >> 2) & 0b11) {
+    case 0b10:
+      i8279->blank_code = 0x20;
+      break;
+    case 0b11:
+      i8279->blank_code = 0xFF;
+      break;
+    default:
+      i8279->blank_code = 0x00;
+      break;
+    }
+    /* The monitor blanks the display with 0xCC. */
+    if ((value & 0b11101) != 0) {
+      for (i = 0; i < I8279_DISPLAY_RAM_MAX; i++) {
+        i8279->display_ram[i] = i8279->blank_code;
       }
+      i8279->display_ram_index = 0;
+    }
+    if (value & 0b11) {
+      i8279_fifo_clear(i8279);
     }
     i8279_update(i8279);
     break;
 
   case 0b111: /* End Interrupt/Error Mode Set */
+    i8279->error_mode = (value >> 4) & 1;
+    i8279_irq_update(i8279);
     break;
 
   default:
@@ -237,84 +700,130 @@ static void i8279_command_word_write(i8279_t *i8279, uint8_t value)
 
 static uint8_t i8279_read_hook(void *i8279, uint16_t address)
 {
-  switch (address) {
-  case MEM_I8279_KEYBOARD_FIFO:
-    ((i8279_t*)i8279)->status_word = 0x00;
-    return ((i8279_t*)i8279)->keyboard_fifo;
+  if (address & MEM_I8279_CONTROL) {
+    return i8279_status_read(i8279);
+  } else {
+    return i8279_data_read(i8279);
+  }
+}
 
-  case MEM_I8279_STATUS:
-    return ((i8279_t*)i8279)->status_word;
 
-  default:
-    return 0;
+
+static uint8_t i8279_peek_hook(void *cookie, uint16_t address)
+{
+  i8279_t *i8279 = cookie;
+
+  /* What a read would return, without popping or auto-incrementing. */
+  if (address & MEM_I8279_CONTROL) {
+    return i8279_status_read(i8279);
+  }
+  if (i8279->read_display) {
+    return i8279->display_ram[i8279->display_ram_index];
   }
+  if (i8279->keyboard_mode >= 0b100) {
+    return i8279->sensor_ram[i8279->sensor_ram_index];
+  }
+  if (i8279->fifo_count == 0) {
+    return 0xFF;
+  }
+  return i8279->fifo[i8279->fifo_head];
 }
 
 
 
 static void i8279_write_hook(void *i8279, uint16_t address, uint8_t value)
 {
-  switch (address) {
-  case MEM_I8279_DISPLAY_DATA:
-    i8279_display_data_write(i8279, value);
-    break;
-
-  case MEM_I8279_COMMAND:
+  if (address & MEM_I8279_CONTROL) {
     i8279_command_word_write(i8279, value);
-    break;
-
-  default:
-    break;
+  } else {
+    i8279_display_data_write(i8279, value);
   }
 }
 
 
 
-void i8279_init(i8279_t *i8279, mem_t *mem)
+int i8279_init(i8279_t *i8279, i8085_t *cpu, mem_t *mem,
+  const i8279_backend_t *backend)
 {
-  initscr();
+  memset(i8279, 0, sizeof(i8279_t));
+  i8279->backend = backend;
+  i8279->cpu = cpu;
+  i8279->mem = mem;
+
+  if (backend->init != NULL) {
+    if ((backend->init)() != 0) {
+      return -1;
+    }
+  }
   atexit(i8279_exit);
-  noecho();
-  keypad(stdscr, TRUE);
-  timeout(I8279_TIMEOUT);
-#ifdef NCURSES_MOUSE_VERSION
-  mousemask(ALL_MOUSE_EVENTS, NULL);
-#endif /* NCURSES_MOUSE_VERSION */
 
-  memset(i8279, 0, sizeof(i8279_t));
+  i8279_glyph_init();
+  i8279_decode_init();
+
+  i8279->display_ram_limit = 8;
+  i8279->blank_code = 0xFF;
+
+  /* Make sure the initial display contents are reported. */
+  memset(i8279->digit_last, 0xFF, I8279_DIGITS);
+
+  i8279->snapshot_back = 0;
+  atomic_init(&i8279->snapshot_middle, 1);
+  i8279->snapshot_front = 2;
+  atomic_init(&i8279->key_head, 0);
+  atomic_init(&i8279->key_tail, 0);
+
+  if (pipe(i8279->wake_fd) == 0) {
+    fcntl(i8279->wake_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(i8279->wake_fd[1], F_SETFL, O_NONBLOCK);
+  }
+  if (pipe(i8279->render_fd) == 0) {
+    fcntl(i8279->render_fd[0], F_SETFL, O_NONBLOCK);
+    fcntl(i8279->render_fd[1], F_SETFL, O_NONBLOCK);
+  }
+
+  i8279_exit_i8279 = i8279;
+  i8279_resume(i8279);
 
   mem->i8279 = i8279;
   mem->i8279_read  = i8279_read_hook;
+  mem->i8279_peek  = i8279_peek_hook;
   mem->i8279_write = i8279_write_hook;
+
+  return 0;
 }
 
 
 
-i8279_key_t i8279_keyboard_poll(i8279_t *i8279)
+static int i8279_key_wait(i8279_t *i8279, int timeout)
 {
+  struct pollfd pfd;
+  char wake[16];
   int ch;
-#ifdef NCURSES_MOUSE_VERSION
-  MEVENT me;
-#endif /* NCURSES_MOUSE_VERSION */
 
-  if (i8279->inject_size > 0) {
-    if (i8279->inject_delay > 0) {
-      i8279->inject_delay--;
-      ch = ERR;
-    } else {
-      i8279->inject_delay = I8279_INJECT_DELAY;
-      i8279->inject_size--;
-      ch = i8279->inject[i8279->inject_size];
-    }
-  } else {
-    ch = getch();
+  ch = i8279_key_pop(i8279);
+  if (ch != I8279_HOST_KEY_NONE) {
+    return ch;
+  }
+  if (! atomic_load(&i8279->render_running)) {
+    return I8279_HOST_KEY_NONE; /* No host keys when headless. */
   }
 
-  if (ch == ERR) {
-    i8279->keyboard_fifo = 0xFF;
-    return I8279_KEY_NONE;
+  /* Sleep on the wake up pipe until the render thread passes a key. */
+  pfd.fd = i8279->wake_fd[0];
+  pfd.events = POLLIN;
+  if (poll(&pfd, 1, timeout) > 0) {
+    while (read(i8279->wake_fd[0], wake, sizeof(wake)) > 0) {
+      /* Drain */
+    }
   }
 
+  return i8279_key_pop(i8279);
+}
+
+
+
+static i8279_key_t i8279_scancode(i8279_t *i8279, int ch)
+{
   /* Automatically convert to appropriate "scancode": */
   switch (ch) {
   case '0':
@@ -327,8 +836,7 @@ i8279_key_t i8279_keyboard_poll(i8279_t *i8279)
   case '7':
   case '8':
   case '9':
-    i8279->keyboard_fifo = ch - 0x30;
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, ch - 0x30);
     return I8279_KEY_FIFO;
 
   case 'A':
@@ -337,8 +845,7 @@ i8279_key_t i8279_keyboard_poll(i8279_t *i8279)
   case 'D':
   case 'E':
   case 'F':
-    i8279->keyboard_fifo = ch - 0x37;
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, ch - 0x37);
     return I8279_KEY_FIFO;
 
   case 'a':
@@ -347,42 +854,35 @@ i8279_key_t i8279_keyboard_poll(i8279_t *i8279)
   case 'd':
   case 'e':
   case 'f':
-    i8279->keyboard_fifo = ch - 0x57;
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, ch - 0x57);
     return I8279_KEY_FIFO;
 
   case '.':
-    i8279->keyboard_fifo = 0x10; /* Exec */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x10); /* Exec */
     return I8279_KEY_FIFO;
 
   case ',':
-    i8279->keyboard_fifo = 0x11; /* Next */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x11); /* Next */
     return I8279_KEY_FIFO;
 
   case 'G':
   case 'g':
-    i8279->keyboard_fifo = 0x12; /* Go */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x12); /* Go */
     return I8279_KEY_FIFO;
 
   case 'M':
   case 'm':
-    i8279->keyboard_fifo = 0x13; /* Substitute Memory */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x13); /* Substitute Memory */
     return I8279_KEY_FIFO;
 
   case 'X':
   case 'x':
-    i8279->keyboard_fifo = 0x14; /* Examine Registers */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x14); /* Examine Registers */
     return I8279_KEY_FIFO;
 
   case 'S':
   case 's':
-    i8279->keyboard_fifo = 0x15; /* Single Step */
-    i8279->status_word = 0x01;
+    i8279_fifo_push(i8279, 0x15); /* Single Step */
     return I8279_KEY_FIFO;
 
   case 'R':
@@ -397,117 +897,62 @@ i8279_key_t i8279_keyboard_poll(i8279_t *i8279)
   case 'q':
     return I8279_KEY_QUIT;
 
-#ifdef NCURSES_MOUSE_VERSION
-  case KEY_MOUSE:
-    getmouse(&me);
-    if (me.bstate != BUTTON1_CLICKED) {
-      break;
-    }
 
-    if (me.x >=  1 && me.x <=  6 && me.y >= 11 && me.y <= 12) {
-      return I8279_KEY_RESET;
-    } else if (me.x >=  8 && me.x <= 13 && me.y >= 11 && me.y <= 12) {
-      return I8279_KEY_VECT_INTR;
-    } else if (me.x >= 15 && me.x <= 20 && me.y >= 11 && me.y <= 12) {
-      i8279->keyboard_fifo = 0xC;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 22 && me.x <= 27 && me.y >= 11 && me.y <= 12) {
-      i8279->keyboard_fifo = 0xD;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 29 && me.x <= 34 && me.y >= 11 && me.y <= 12) {
-      i8279->keyboard_fifo = 0xE;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 36 && me.x <= 41 && me.y >= 11 && me.y <= 12) {
-      i8279->keyboard_fifo = 0xF;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-
-    } else if (me.x >=  1 && me.x <=  6 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0x15;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >=  8 && me.x <= 13 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0x12;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 15 && me.x <= 20 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0x8;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 22 && me.x <= 27 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0x9;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 29 && me.x <= 34 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0xA;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 36 && me.x <= 41 && me.y >= 14 && me.y <= 15) {
-      i8279->keyboard_fifo = 0xB;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-
-    } else if (me.x >=  1 && me.x <=  6 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x13;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >=  8 && me.x <= 13 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x14;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 15 && me.x <= 20 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x4;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 22 && me.x <= 27 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x5;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 29 && me.x <= 34 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x6;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 36 && me.x <= 41 && me.y >= 17 && me.y <= 18) {
-      i8279->keyboard_fifo = 0x7;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-
-    } else if (me.x >=  1 && me.x <=  6 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x11;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >=  8 && me.x <= 13 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x10;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 15 && me.x <= 20 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x0;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 22 && me.x <= 27 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x1;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 29 && me.x <= 34 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x2;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    } else if (me.x >= 36 && me.x <= 41 && me.y >= 20 && me.y <= 21) {
-      i8279->keyboard_fifo = 0x3;
-      i8279->status_word = 0x01;
-      return I8279_KEY_FIFO;
-    }
+  default:
     break;
-#endif /* NCURSES_MOUSE_VERSION */
+  }
+
+  return I8279_KEY_NONE;
+}
+
 
+
+i8279_key_t i8279_keyboard_press(i8279_t *i8279, int ch)
+{
+  i8279_key_t key;
+
+  key = i8279_scancode(i8279, ch);
+  switch (key) {
+  case I8279_KEY_RESET:
+    i8085_reset(i8279->cpu);
+    break;
+  case I8279_KEY_VECT_INTR:
+    i8085_rst_75(i8279->cpu, i8279->mem);
+    break;
+  case I8279_KEY_FIFO: /* Interrupt is raised by the FIFO. */
+  case I8279_KEY_QUIT:
+  case I8279_KEY_NONE:
   default:
     break;
   }
 
-  return I8279_KEY_NONE;
+  return key;
+}
+
+
+
+i8279_key_t i8279_keyboard_poll(i8279_t *i8279, int timeout)
+{
+  int ch;
+
+  if (i8279->inject_size > 0) {
+    if (i8279->inject_delay > 0) {
+      i8279->inject_delay--;
+      ch = I8279_HOST_KEY_NONE;
+    } else {
+      i8279->inject_delay = I8279_INJECT_DELAY;
+      i8279->inject_size--;
+      ch = i8279->inject[i8279->inject_size];
+    }
+  } else {
+    ch = i8279_key_wait(i8279, timeout);
+  }
+
+  if (ch == I8279_HOST_KEY_NONE) {
+    return I8279_KEY_NONE;
+  }
+
+  return i8279_keyboard_press(i8279, ch);
 }
 
 
@@ -1,21 +1,110 @@
 #ifndef _I8279_H
 #define _I8279_H
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include "i8085.h"
 #include "mem.h"
 
 #define I8279_DISPLAY_RAM_MAX 16
+#define I8279_SENSOR_RAM_MAX 8
+#define I8279_FIFO_SIZE 8
+#define I8279_DIGITS 6
+#define I8279_KEY_QUEUE_SIZE 64
 #define I8279_INJECT_MAX 2048
 #define I8279_INJECT_DELAY 10
 
+#define I8279_GLYPH_HEIGHT 9
+#define I8279_GLYPH_WIDTH 7
+
+/* Decoded text is one character per digit plus any decimal points. */
+#define I8279_TEXT_MAX (I8279_DIGITS * 2 + 1)
+
+/* Binary capture record: 64-bit little endian cycles and the raw digits. */
+#define I8279_CAPTURE_RECORD_SIZE (8 + I8279_DIGITS)
+
+typedef void (*i8279_display_hook_t)(void *, uint64_t, const uint8_t *);
+
+/* Host key value when no key is available. */
+#define I8279_HOST_KEY_NONE -1
+
+typedef struct i8279_text_s {
+  int y;
+  int x;
+  const char *text;
+} i8279_text_t;
+
+/* Host display backend, all operations are called from the render thread
+ * except init, pause and resume. The key operation must not block, it is
+ * called when input_fd is readable. A backend without key and draw
+ * operations runs headless and no render thread is started. */
+typedef struct i8279_backend_s {
+  const char *name;
+  int input_fd;
+  int (*init)(void);
+  void (*pause)(void);
+  void (*resume)(void);
+  void (*draw_layout)(void);
+  void (*draw_digit)(uint8_t display_ram, int x);
+  void (*flush)(void);
+  int (*key)(void);
+} i8279_backend_t;
+
+extern const i8279_backend_t i8279_backend_curses;
+extern const i8279_backend_t i8279_backend_ansi;
+extern const i8279_backend_t i8279_backend_headless;
+
+extern const i8279_text_t i8279_keyboard_text[];
+extern const i8279_text_t i8279_help_text[];
+
 typedef struct i8279_s {
-  uint8_t keyboard_fifo;
-  uint8_t status_word;
+  const i8279_backend_t *backend;
+  i8085_t *cpu;
+  mem_t *mem;
+  uint8_t fifo[I8279_FIFO_SIZE];
+  unsigned int fifo_head;
+  unsigned int fifo_count;
+  bool fifo_overrun;
+  bool fifo_underrun;
+  unsigned long fifo_overruns;
+  uint8_t keyboard_mode;
+  bool error_mode;
+  uint8_t sensor_ram[I8279_SENSOR_RAM_MAX];
+  unsigned int sensor_ram_index;
+  bool sensor_auto_increment;
+  bool read_display;
   uint8_t display_ram[I8279_DISPLAY_RAM_MAX];
+  uint8_t display_shown[I8279_DISPLAY_RAM_MAX];
   unsigned int display_ram_index;
   unsigned int display_ram_limit;
   bool auto_increment;
+  bool inhibit_a;
+  bool inhibit_b;
+  bool blank_a;
+  bool blank_b;
+  uint8_t blank_code;
+  uint8_t snapshot[3][I8279_DISPLAY_RAM_MAX];
+  uint8_t snapshot_back;
+  _Atomic uint8_t snapshot_middle;
+  uint8_t snapshot_front;
+  int key_queue[I8279_KEY_QUEUE_SIZE];
+  _Atomic unsigned int key_head;
+  _Atomic unsigned int key_tail;
+  int wake_fd[2];
+  int render_fd[2];
+  pthread_t render_thread;
+  atomic_bool render_running;
+  bool layout_drawn;
+  bool digit_drawn[I8279_DIGITS];
+  uint8_t digit_rendered[I8279_DIGITS];
+  uint8_t digit_last[I8279_DIGITS];
+  FILE *capture_fh;
+  bool capture_binary;
+  i8279_display_hook_t display_hook;
+  void *display_cookie;
   int inject[I8279_INJECT_MAX];
   unsigned int inject_size;
   unsigned int inject_delay;
@@ -29,11 +118,18 @@ typedef enum {
   I8279_KEY_QUIT,
 } i8279_key_t;
 
-void i8279_pause(void);
-void i8279_resume(void);
-void i8279_init(i8279_t *i8279, mem_t *mem);
+void i8279_pause(i8279_t *i8279);
+void i8279_resume(i8279_t *i8279);
+const i8279_backend_t *i8279_backend_find(const char *name);
+const char *i8279_glyph(uint8_t display_ram, int row);
+char i8279_decode(uint8_t display_ram);
+size_t i8279_display_text(i8279_t *i8279, char *text);
+int i8279_capture(i8279_t *i8279, const char *filename, bool binary);
+int i8279_init(i8279_t *i8279, i8085_t *cpu, mem_t *mem,
+  const i8279_backend_t *backend);
 void i8279_update(i8279_t *i8279);
-i8279_key_t i8279_keyboard_poll(i8279_t *i8279);
+i8279_key_t i8279_keyboard_press(i8279_t *i8279, int ch);
+i8279_key_t i8279_keyboard_poll(i8279_t *i8279, int timeout);
 void i8279_keyboard_inject(i8279_t *i8279, int ch);
 
 #endif /* _I8279_H */
@@ -0,0 +1,174 @@
+#include "i8279.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Whole frame is collected here and written with a single write(). */
+#define I8279_ANSI_FRAME_MAX 8192
+
+static char i8279_ansi_frame[I8279_ANSI_FRAME_MAX];
+static size_t i8279_ansi_frame_len = 0;
+
+static struct termios i8279_ansi_termios;
+static bool i8279_ansi_raw = false;
+
+
+
+static void i8279_ansi_printf(const char *format, ...)
+{
+  va_list args;
+  int n;
+
+  va_start(args, format);
+  n = vsnprintf(&i8279_ansi_frame[i8279_ansi_frame_len],
+    I8279_ANSI_FRAME_MAX - i8279_ansi_frame_len, format, args);
+  va_end(args);
+
+  if (n > 0) {
+    i8279_ansi_frame_len += n;
+    if (i8279_ansi_frame_len >= I8279_ANSI_FRAME_MAX) {
+      i8279_ansi_frame_len = I8279_ANSI_FRAME_MAX - 1; /* Truncated. */
+    }
+  }
+}
+
+
+
+static void i8279_ansi_flush(void)
+{
+  size_t done = 0;
+  ssize_t n;
+
+  while (done < i8279_ansi_frame_len) {
+    n = write(STDOUT_FILENO, &i8279_ansi_frame[done],
+      i8279_ansi_frame_len - done);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    done += n;
+  }
+  i8279_ansi_frame_len = 0;
+}
+
+
+
+static int i8279_ansi_init(void)
+{
+  if (tcgetattr(STDIN_FILENO, &i8279_ansi_termios) != 0) {
+    return -1;
+  }
+  return 0;
+}
+
+
+
+static void i8279_ansi_pause(void)
+{
+  if (! i8279_ansi_raw) {
+    return;
+  }
+
+  /* Show cursor and leave it below the keyboard. */
+  i8279_ansi_printf("\x1b[?25h\x1b[24;1H\n");
+  i8279_ansi_flush();
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, &i8279_ansi_termios);
+  i8279_ansi_raw = false;
+}
+
+
+
+static void i8279_ansi_resume(void)
+{
+  struct termios raw;
+
+  /* Unbuffered keys without echo, but keep Ctrl-C for the debugger. */
+  raw = i8279_ansi_termios;
+  raw.c_lflag &= ~(ICANON | ECHO);
+  raw.c_cc[VMIN] = 0;
+  raw.c_cc[VTIME] = 0;
+  tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw);
+  i8279_ansi_raw = true;
+
+  /* Hide cursor and clear screen. */
+  i8279_ansi_printf("\x1b[?25l\x1b[H\x1b[2J");
+  i8279_ansi_flush();
+}
+
+
+
+static void i8279_ansi_draw_layout(void)
+{
+  const i8279_text_t *t;
+  const char *p;
+  int y;
+
+  /* Display the keyboard using DEC line drawing characters, the labels
+   * are all below 0x5F and therefore unaffected by the character set. */
+  i8279_ansi_printf("\x1b(0");
+  for (t = i8279_keyboard_text; t->text != NULL; t++) {
+    i8279_ansi_printf("\x1b[%d;%dH", t->y + 1, t->x + 1);
+    for (p = t->text; *p != '\0'; p++) {
+      i8279_ansi_printf("%c", (*p == '|') ? 'x' : *p);
+    }
+  }
+  for (y = 10; y <= 22; y += 3) {
+    i8279_ansi_printf("\x1b[%d;1H"
+      "qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq", y + 1);
+  }
+  i8279_ansi_printf("\x1b(B");
+
+  /* Display some helpful information: */
+  for (t = i8279_help_text; t->text != NULL; t++) {
+    i8279_ansi_printf("\x1b[%d;%dH%s", t->y + 1, t->x + 1, t->text);
+  }
+}
+
+
+
+static void i8279_ansi_draw_digit(uint8_t display_ram, int x)
+{
+  int i;
+
+  for (i = 0; i < I8279_GLYPH_HEIGHT; i++) {
+    i8279_ansi_printf("\x1b[%d;%dH%s", i + 1, x + 1,
+      i8279_glyph(display_ram, i));
+  }
+}
+
+
+
+static int i8279_ansi_key(void)
+{
+  unsigned char ch;
+
+  /* Terminal is set up with VMIN=0 and VTIME=0, so this never blocks. */
+  if (read(STDIN_FILENO, &ch, 1) != 1) {
+    return I8279_HOST_KEY_NONE;
+  }
+  return ch;
+}
+
+
+
+const i8279_backend_t i8279_backend_ansi = {
+  .name        = "ansi",
+  .input_fd    = STDIN_FILENO,
+  .init        = i8279_ansi_init,
+  .pause       = i8279_ansi_pause,
+  .resume      = i8279_ansi_resume,
+  .draw_layout = i8279_ansi_draw_layout,
+  .draw_digit  = i8279_ansi_draw_digit,
+  .flush       = i8279_ansi_flush,
+  .key         = i8279_ansi_key,
+};
+
+
+
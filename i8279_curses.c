@@ -0,0 +1,136 @@
+#include "i8279.h"
+#include <curses.h>
+#include <stdint.h>
+#include <unistd.h>
+
+#ifdef NCURSES_MOUSE_VERSION
+static const char i8279_curses_mouse_key[4][6] = {
+  {'R', 'I', 'C', 'D', 'E', 'F'},
+  {'S', 'G', '8', '9', 'A', 'B'},
+  {'M', 'X', '4', '5', '6', '7'},
+  {',', '.', '0', '1', '2', '3'},
+};
+#endif /* NCURSES_MOUSE_VERSION */
+
+
+
+static int i8279_curses_init(void)
+{
+  initscr();
+  noecho();
+  keypad(stdscr, TRUE);
+  nodelay(stdscr, TRUE);
+#ifdef NCURSES_MOUSE_VERSION
+  mousemask(ALL_MOUSE_EVENTS, NULL);
+#endif /* NCURSES_MOUSE_VERSION */
+  return 0;
+}
+
+
+
+static void i8279_curses_pause(void)
+{
+  endwin();
+}
+
+
+
+static void i8279_curses_resume(void)
+{
+  refresh();
+}
+
+
+
+static void i8279_curses_draw_layout(void)
+{
+  const i8279_text_t *t;
+
+  /* Display the keyboard: */
+  for (t = i8279_keyboard_text; t->text != NULL; t++) {
+    mvaddstr(t->y, t->x, t->text);
+  }
+  mvvline(11, 0, ACS_VLINE, 11);
+  mvvline(11, 7, ACS_VLINE, 11);
+  mvvline(11, 14, ACS_VLINE, 11);
+  mvvline(11, 21, ACS_VLINE, 11);
+  mvvline(11, 28, ACS_VLINE, 11);
+  mvvline(11, 35, ACS_VLINE, 11);
+  mvvline(11, 42, ACS_VLINE, 11);
+  mvhline(10, 0, ACS_HLINE, 43);
+  mvhline(13, 0, ACS_HLINE, 43);
+  mvhline(16, 0, ACS_HLINE, 43);
+  mvhline(19, 0, ACS_HLINE, 43);
+  mvhline(22, 0, ACS_HLINE, 43);
+
+  /* Display some helpful information: */
+  for (t = i8279_help_text; t->text != NULL; t++) {
+    mvaddstr(t->y, t->x, t->text);
+  }
+}
+
+
+
+static void i8279_curses_draw_digit(uint8_t display_ram, int x)
+{
+  int i;
+
+  for (i = 0; i < I8279_GLYPH_HEIGHT; i++) {
+    mvaddstr(i, x, i8279_glyph(display_ram, i));
+  }
+}
+
+
+
+static void i8279_curses_flush(void)
+{
+  refresh();
+}
+
+
+
+static int i8279_curses_key(void)
+{
+  int ch;
+#ifdef NCURSES_MOUSE_VERSION
+  MEVENT me;
+#endif /* NCURSES_MOUSE_VERSION */
+
+  ch = getch();
+
+#ifdef NCURSES_MOUSE_VERSION
+  if (ch == KEY_MOUSE) {
+    /* Convert clicks on the virtual keyboard to the matching key. */
+    if (getmouse(&me) != OK || me.bstate != BUTTON1_CLICKED) {
+      return I8279_HOST_KEY_NONE;
+    }
+    if (me.x < 1 || me.x > 41 || ((me.x - 1) % 7) == 6 ||
+        me.y < 11 || me.y > 21 || ((me.y - 11) % 3) == 2) {
+      return I8279_HOST_KEY_NONE;
+    }
+    return i8279_curses_mouse_key[(me.y - 11) / 3][(me.x - 1) / 7];
+  }
+#endif /* NCURSES_MOUSE_VERSION */
+
+  if (ch == ERR) {
+    return I8279_HOST_KEY_NONE;
+  }
+  return ch;
+}
+
+
+
+const i8279_backend_t i8279_backend_curses = {
+  .name        = "curses",
+  .input_fd    = STDIN_FILENO,
+  .init        = i8279_curses_init,
+  .pause       = i8279_curses_pause,
+  .resume      = i8279_curses_resume,
+  .draw_layout = i8279_curses_draw_layout,
+  .draw_digit  = i8279_curses_draw_digit,
+  .flush       = i8279_curses_flush,
+  .key         = i8279_curses_key,
+};
+
+
+
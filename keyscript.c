@@ -0,0 +1,106 @@
+#include "keyscript.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i8279.h"
+#include "scheduler.h"
+
+
+
+static int keyscript_next(keyscript_t *keyscript)
+{
+  char line[KEYSCRIPT_LINE_MAX];
+  char *p;
+  char *end;
+  unsigned long long value;
+  char stamp;
+
+  /* Only one line is read at a time, so scripts can be any length. */
+  while (fgets(line, sizeof(line), keyscript->fh) != NULL) {
+    keyscript->line_no++;
+
+    p = line;
+    while (isspace((unsigned char)*p)) {
+      p++;
+    }
+    if (*p == '\0' || *p == '#') {
+      continue; /* Empty or comment. */
+    }
+
+    /* "@CYCLES KEY" is absolute, "+CYCLES KEY" is after the previous key. */
+    stamp = *p++;
+    value = strtoull(p, &end, 0);
+    if ((stamp != '@' && stamp != '+') || end == p ||
+        ! isspace((unsigned char)*end)) {
+      break;
+    }
+    p = end;
+    while (isspace((unsigned char)*p)) {
+      p++;
+    }
+    if (*p == '\0') {
+      break;
+    }
+
+    if (stamp == '@') {
+      keyscript->cycles = value;
+    } else {
+      keyscript->cycles += value;
+    }
+    keyscript->key = *p;
+    return 0;
+  }
+
+  if (! feof(keyscript->fh)) {
+    fprintf(stdout, "Error in key script %s:%d\n", keyscript->filename,
+      keyscript->line_no);
+  }
+  fclose(keyscript->fh);
+  keyscript->fh = NULL;
+  return -1;
+}
+
+
+
+static void keyscript_event(void *keyscript, uint64_t cycles)
+{
+  keyscript_t *k = keyscript;
+
+  (void)cycles;
+
+  if (i8279_keyboard_press(k->i8279, k->key) == I8279_KEY_QUIT) {
+    exit(EXIT_SUCCESS);
+  }
+
+  if (keyscript_next(k) == 0) {
+    scheduler_add(k->scheduler, k->cycles, keyscript_event, k);
+  }
+}
+
+
+
+int keyscript_init(keyscript_t *keyscript, const char *filename,
+  scheduler_t *scheduler, i8279_t *i8279)
+{
+  memset(keyscript, 0, sizeof(keyscript_t));
+
+  keyscript->fh = fopen(filename, "r");
+  if (keyscript->fh == NULL) {
+    return -1;
+  }
+  keyscript->filename = filename;
+  keyscript->scheduler = scheduler;
+  keyscript->i8279 = i8279;
+
+  if (keyscript_next(keyscript) == 0) {
+    return scheduler_add(scheduler, keyscript->cycles, keyscript_event,
+      keyscript);
+  }
+  return 0;
+}
+
+
+
@@ -0,0 +1,24 @@
+#ifndef _KEYSCRIPT_H
+#define _KEYSCRIPT_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "i8279.h"
+#include "scheduler.h"
+
+#define KEYSCRIPT_LINE_MAX 128
+
+typedef struct keyscript_s {
+  FILE *fh;
+  const char *filename;
+  int line_no;
+  uint64_t cycles; /* Stamp of the pending key. */
+  int key;
+  scheduler_t *scheduler;
+  i8279_t *i8279;
+} keyscript_t;
+
+int keyscript_init(keyscript_t *keyscript, const char *filename,
+  scheduler_t *scheduler, i8279_t *i8279);
+
+#endif /* _KEYSCRIPT_H */
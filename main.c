@@ -1,3 +1,4 @@
+#include <poll.h>
 #include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
@@ -10,6 +11,14 @@
 #include "i8279.h"
 #include "i8155.h"
 #include "serial.h"
+#include "script.h"
+#include "scheduler.h"
+#include "keyscript.h"
+#include "pace.h"
+#include "debugger.h"
+#include "disasm.h"
+#include "profile.h"
+#include "sampler.h"
 #include "mem.h"
 #include "io.h"
 
@@ -19,135 +28,146 @@ static i8085_t cpu;
 static i8279_t i8279;
 static i8155_t i8155;
 static serial_t serial;
+static script_t script;
+static scheduler_t scheduler;
+static keyscript_t keyscript;
+static pace_t pace;
+static debugger_t debugger_state;
+static profile_t profile;
+static sampler_t sampler;
 static mem_t mem;
 static io_t io;
 
+static char *save_filename = NULL;
+static unsigned int save_start;
+static unsigned int save_end;
+static char *profile_filename = NULL;
+static char *sampler_filename = NULL;
+
 static bool debugger_break = false;
-int32_t debugger_breakpoint = -1;
 static char panic_msg[80];
 
 
 
-static void debugger_help(void)
+void panic(const char *format, ...)
 {
-  fprintf(stdout, "Commands:\n");
-  fprintf(stdout, "  q              - Quit\n");
-  fprintf(stdout, "  h              - Help\n");
-  fprintf(stdout, "  c              - Continue\n");
-  fprintf(stdout, "  s              - Step\n");
-  fprintf(stdout, "  t              - Dump CPU Trace\n");
-  fprintf(stdout, "  d <addr> [end] - Dump Memory\n");
-  fprintf(stdout, "  b <addr>       - Breakpoint at address.\n");
+  va_list args;
+
+  va_start(args, format);
+  vsnprintf(panic_msg, sizeof(panic_msg), format, args);
+  va_end(args);
+
+  debugger_break = true;
 }
 
 
 
-bool debugger(i8085_t *cpu, mem_t *mem)
+static bool host_idle(void)
 {
-  char input[128];
-  char *argv[3];
-  int argc;
-  int value1;
-  int value2;
+  /* Only host input can change anything, nothing is scheduled or pending.
+   * A debugger run target must keep running to get back to the prompt. */
+  return scheduler.next_active == SCHEDULER_NEVER &&
+    script.fh == NULL && ! debugger_state.run &&
+    ! i8155.timer_running && ! i8155.trap &&
+    ! cpu.rst55_line;
+}
 
-  fprintf(stdout, "\n");
-  while (1) {
-    fprintf(stdout, "\r%04hX> ", cpu->pc);
 
-    if (fgets(input, sizeof(input), stdin) == NULL) {
-      if (feof(stdin)) {
-        exit(EXIT_SUCCESS);
-      }
-      continue;
-    }
 
-    if ((strlen(input) > 0) && (input[strlen(input) - 1] == '\n')) {
-      input[strlen(input) - 1] = '\0'; /* Strip newline. */
-    }
+static bool keyboard_idle(void)
+{
+  return i8279.inject_size == 0 && host_idle();
+}
 
-    argv[0] = strtok(input, " ");
-    if (argv[0] == NULL) {
-      continue;
-    }
 
-    for (argc = 1; argc < 3; argc++) {
-      argv[argc] = strtok(NULL, " ");
-      if (argv[argc] == NULL) {
-        break;
-      }
-    }
 
-    if (strncmp(argv[0], "q", 1) == 0) {
-      exit(EXIT_SUCCESS);
+static uint64_t next_deadline(bool serial_mode)
+{
+  uint64_t deadline;
+  uint64_t next;
+
+  /* Earliest cycle where anything outside the CPU can happen. */
+  deadline = scheduler.next_active;
+  next = i8155_deadline(&i8155);
+  if (next < deadline) {
+    deadline = next;
+  }
+  if (pace.next_cycles < deadline) {
+    deadline = pace.next_cycles;
+  }
+  if (debugger_state.run_cycles < deadline) {
+    deadline = debugger_state.run_cycles;
+  }
+  if (script.fh != NULL && script.next_cycles < deadline) {
+    deadline = script.next_cycles;
+  }
+  if (serial_mode) {
+    next = serial_deadline(&serial, &cpu);
+    if (next < deadline) {
+      deadline = next;
+    }
+  } else if (i8279.inject_size > 0) {
+    deadline = cpu.cycles; /* Injected keys are delivered by polls. */
+  }
 
-    } else if (strncmp(argv[0], "?", 1) == 0) {
-      debugger_help();
+  return deadline;
+}
 
-    } else if (strncmp(argv[0], "h", 1) == 0) {
-      debugger_help();
 
-    } else if (strncmp(argv[0], "c", 1) == 0) {
-      return false;
 
-    } else if (strncmp(argv[0], "s", 1) == 0) {
-      return true;
+static void save_at_exit(void)
+{
+  int result;
 
-    } else if (strncmp(argv[0], "t", 1) == 0) {
-      i8085_trace_dump(stdout);
+  if (mem_hex_filename(save_filename)) {
+    result = mem_save_to_hex_file(&mem, save_filename, save_start, save_end);
+  } else {
+    result = mem_save_to_binary_file(&mem, save_filename, save_start,
+      save_end);
+  }
+  if (result != 0) {
+    fprintf(stdout, "Error saving memory file: %s\n", save_filename);
+  }
+}
 
-    } else if (strncmp(argv[0], "d", 1) == 0) {
-      if (argc >= 3) {
-        sscanf(argv[1], "%4x", &value1);
-        sscanf(argv[2], "%4x", &value2);
-        mem_dump(stdout, mem, (uint32_t)value1, (uint32_t)value2);
-      } else if (argc >= 2) {
-        sscanf(argv[1], "%4x", &value1);
-        value2 = value1 + 0xFF;
-        if (value2 > 0xFFFF) {
-          value2 = 0xFFFF; /* Truncate */
-        }
-        mem_dump(stdout, mem, (uint32_t)value1, (uint32_t)value2);
-      } else {
-        fprintf(stdout, "Missing argument!\n");
-      }
 
-    } else if (strncmp(argv[0], "b", 1) == 0) {
-      if (argc >= 2) {
-        if (sscanf(argv[1], "%4x", &value1) == 1) {
-          debugger_breakpoint = (value1 & 0xFFFF);
-          fprintf(stdout, "Breakpoint at 0x%04X set.\n",
-            debugger_breakpoint);
-        } else {
-          fprintf(stdout, "Invalid argument!\n");
-        }
-      } else {
-        if (debugger_breakpoint < 0) {
-          fprintf(stdout, "Missing argument!\n");
-        } else {
-          fprintf(stdout, "Breakpoint at 0x%04X removed.\n",
-            debugger_breakpoint);
-        }
-        debugger_breakpoint = -1;
-      }
 
-    } else {
-      fprintf(stdout, "Unknown command: '%c' (use 'h' for help.)\n",
-        argv[0][0]);
-    }
+static void profile_at_exit(void)
+{
+  if (profile_write(&profile, profile_filename) != 0) {
+    fprintf(stdout, "Error writing profile file: %s\n", profile_filename);
   }
 }
 
 
 
-void panic(const char *format, ...)
+static void sampler_at_exit(void)
 {
-  va_list args;
+  if (sampler_write(&sampler, sampler_filename) != 0) {
+    fprintf(stdout, "Error writing samples file: %s\n", sampler_filename);
+  }
+}
 
-  va_start(args, format);
-  vsnprintf(panic_msg, sizeof(panic_msg), format, args);
-  va_end(args);
 
-  debugger_break = true;
+
+static int load_file(char *spec)
+{
+  char *comma;
+  unsigned int address;
+
+  /* "FILE.hex" for HEX files, "FILE,ADDR" for binary files, the same
+   * rule as the debugger "load" command. */
+  comma = strrchr(spec, ',');
+  if (comma != NULL) {
+    *comma++ = '\0';
+  }
+  if (mem_hex_filename(spec)) {
+    return (comma == NULL) ? mem_load_from_hex_file(&mem, spec) : -1;
+  }
+  if (comma == NULL || sscanf(comma, "%4x", &address) != 1) {
+    return -1;
+  }
+  return mem_load_from_binary_file(&mem, spec, address);
 }
 
 
@@ -169,11 +189,37 @@ static void display_help(const char *progname)
   fprintf(stdout, "Options:\n"
     "  -h          Display this help.\n"
     "  -d          Break into debugger on start.\n"
+    "  -x FILE     Run debugger commands from FILE, starting in debugger.\n"
+    "  -o FILE     Write debugger output to FILE.\n"
+    "  -l FILE     Load FILE.hex as HEX, or binary FILE,ADDR into memory.\n"
+    "  -w FILE,START,END\n"
+    "              Save memory START-END at exit as HEX (.hex) or binary.\n"
+    "  -m FILE     Load symbols for traces and disassembly from FILE.\n"
+    "  -P FILE     Profile execution, callgrind output to FILE at exit.\n"
+    "  -p CYCLES,FILE\n"
+    "              Sample PC every CYCLES, folded stacks to FILE at exit.\n"
+    "  -n          No fast-forward of idle and delay loops.\n"
+    "  -r SPEED    Run at SPEED times the real 3.072 MHz, default is 0.\n"
     "  -s          Run in serial mode instead of display/keyboard mode.\n"
+    "  -b BAUD     Serial mode baud rate, default is %d.\n"
+    "  -f FRAME    Serial mode frame format, default is '%s'.\n"
+    "  -S DEVICE   Serial mode device, default is 'stdio'.\n"
     "  -e FILE     Load additional expansion ROM from HEX FILE.\n"
     "  -i STRING   Inject keyboard data STRING in display/keyboard mode.\n"
-    "\n");
-  fprintf(stdout, "HEX files should be in Intel format.\n"
+    "  -k FILE     Play key script FILE in display/keyboard mode.\n"
+    "  -E FILE     Run send/expect (with -s) or key/expect script FILE.\n"
+    "  -D BACKEND  Display backend, default is 'curses'.\n"
+    "  -c FILE     Capture decoded display changes as text to FILE.\n"
+    "  -C FILE     Capture display changes as binary records to FILE.\n"
+    "\n", SERIAL_DEFAULT_BAUD_RATE, SERIAL_DEFAULT_FRAME);
+  fprintf(stdout, "Serial FRAME is data bits, parity (N/E/O) and stop bits."
+    "\n"
+    "Serial DEVICE is 'stdio', 'pty', 'unix:PATH' or 'file:INPUT[,OUTPUT]'.\n"
+    "Display BACKEND is 'curses', 'ansi' (raw terminal) or 'headless'.\n"
+    "Capture FILE '-' is standard out, best used with the headless backend.\n"
+    "Symbol FILE lines are 'ADDR NAME' with the address in hex.\n"
+    "Key script lines are '@CYCLES KEY' or '+CYCLES KEY' (after previous).\n"
+    "HEX files should be in Intel format.\n"
     "If no monitor HEX file is specified then '" DEFAULT_MONITOR_HEX_FILE
     "' will be loaded.\n"
     "\n");
@@ -184,12 +230,30 @@ static void display_help(const char *progname)
 int main(int argc, char *argv[])
 {
   int c;
+  uint64_t deadline;
+  uint16_t pc;
   char *monitor_hex_filename = NULL;
   char *expansion_hex_filename = NULL;
   char *keyboard_inject = NULL;
   bool serial_mode = false;
-
-  while ((c = getopt(argc, argv, "hdse:i:")) != -1) {
+  int serial_baud_rate = SERIAL_DEFAULT_BAUD_RATE;
+  char *serial_frame = SERIAL_DEFAULT_FRAME;
+  char *serial_device = NULL;
+  char *script_filename = NULL;
+  const i8279_backend_t *display_backend = &i8279_backend_curses;
+  char *capture_filename = NULL;
+  char *keyscript_filename = NULL;
+  bool skip_loops = true;
+  double speed = 0.0;
+  bool capture_binary = false;
+  char *debugger_script = NULL;
+  char *load_filename = NULL;
+  char *symbol_filename = NULL;
+  char *debugger_output = NULL;
+  uint64_t sampler_interval = 0;
+
+  while ((c = getopt(argc, argv,
+    "hdx:o:l:w:m:P:p:nr:sb:f:S:e:i:k:E:D:c:C:")) != -1) {
     switch (c) {
     case 'h':
       display_help(argv[0]);
@@ -199,10 +263,77 @@ int main(int argc, char *argv[])
       debugger_break = true;
       break;
 
+    case 'x':
+      debugger_script = optarg;
+      debugger_break = true;
+      break;
+
+    case 'o':
+      debugger_output = optarg;
+      break;
+
+    case 'l':
+      load_filename = optarg;
+      break;
+
+    case 'w':
+      save_filename = optarg;
+      if (sscanf(optarg, "%*[^,],%4x,%4x", &save_start, &save_end) != 2 ||
+          save_end < save_start) {
+        display_help(argv[0]);
+        return EXIT_FAILURE;
+      }
+      *strchr(save_filename, ',') = '\0';
+      if (mem_range_aliased(save_start, save_end)) {
+        fprintf(stdout, "Save range repeats in the mirrored 256 byte RAM: "
+          "%04X-%04X\n", save_start, save_end);
+        return EXIT_FAILURE;
+      }
+      break;
+
+    case 'm':
+      symbol_filename = optarg;
+      break;
+
+    case 'P':
+      profile_filename = optarg;
+      break;
+
+    case 'p':
+      sampler_filename = strchr(optarg, ',');
+      sampler_interval = strtoull(optarg, NULL, 10);
+      if (sampler_filename == NULL || sampler_interval == 0) {
+        display_help(argv[0]);
+        return EXIT_FAILURE;
+      }
+      sampler_filename++;
+      break;
+
+    case 'n':
+      skip_loops = false;
+      break;
+
+    case 'r':
+      speed = atof(optarg);
+      break;
+
     case 's':
       serial_mode = true;
       break;
 
+    case 'b':
+      serial_baud_rate = atoi(optarg);
+      break;
+
+    case 'f':
+      serial_frame = optarg;
+      break;
+
+    case 'S':
+      serial_device = optarg;
+      serial_mode = true;
+      break;
+
     case 'e':
       expansion_hex_filename = optarg;
       break;
@@ -211,6 +342,32 @@ int main(int argc, char *argv[])
       keyboard_inject = optarg;
       break;
 
+    case 'k':
+      keyscript_filename = optarg;
+      break;
+
+    case 'E':
+      script_filename = optarg;
+      break;
+
+    case 'D':
+      display_backend = i8279_backend_find(optarg);
+      if (display_backend == NULL) {
+        fprintf(stdout, "Unknown display backend: %s\n", optarg);
+        return EXIT_FAILURE;
+      }
+      break;
+
+    case 'c':
+      capture_filename = optarg;
+      capture_binary = false;
+      break;
+
+    case 'C':
+      capture_filename = optarg;
+      capture_binary = true;
+      break;
+
     case '?':
     default:
       display_help(argv[0]);
@@ -228,6 +385,7 @@ int main(int argc, char *argv[])
   signal(SIGINT, sig_handler);
 
   i8085_init(&cpu, &io);
+  scheduler_init(&scheduler);
   i8085_trace_init();
   mem_init(&mem);
   io_init(&io);
@@ -253,11 +411,52 @@ int main(int argc, char *argv[])
     }
   }
 
+  if (symbol_filename != NULL) {
+    if (disasm_symbols_load(symbol_filename) != 0) {
+      fprintf(stdout, "Error loading symbol file: %s\n", symbol_filename);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (load_filename != NULL) {
+    if (load_file(load_filename) != 0) {
+      fprintf(stdout, "Error loading memory file: %s\n", load_filename);
+      return EXIT_FAILURE;
+    }
+  }
+  if (save_filename != NULL) {
+    atexit(save_at_exit);
+  }
+  if (profile_filename != NULL) {
+    profile_init(&profile);
+    atexit(profile_at_exit);
+    skip_loops = false; /* Skipped loops would be missing from the profile. */
+  }
+
   if (serial_mode) {
-    cpu.mask.sid = 1;
-    serial_init(&serial);
+    if (script_filename != NULL && serial_device == NULL) {
+      serial_device = "none"; /* Script provides all input. */
+    }
+    if (serial_init(&serial, &cpu, serial_baud_rate, serial_frame,
+      serial_device) != 0) {
+      fprintf(stdout, "Error setting up serial device: %s %d %s\n",
+        serial_device != NULL ? serial_device : "stdio",
+        serial_baud_rate, serial_frame);
+      return EXIT_FAILURE;
+    }
   } else {
-    i8279_init(&i8279, &mem);
+    if (i8279_init(&i8279, &cpu, &mem, display_backend) != 0) {
+      fprintf(stdout, "Error setting up display backend: %s\n",
+        display_backend->name);
+      return EXIT_FAILURE;
+    }
+    if (capture_filename != NULL) {
+      if (i8279_capture(&i8279, capture_filename, capture_binary) != 0) {
+        fprintf(stdout, "Error opening display capture file: %s\n",
+          capture_filename);
+        return EXIT_FAILURE;
+      }
+    }
     i8279_update(&i8279);
 
     if (keyboard_inject != NULL) {
@@ -267,66 +466,141 @@ int main(int argc, char *argv[])
         i8279_keyboard_inject(&i8279, keyboard_inject[c]);
       }
     }
+
+    if (keyscript_filename != NULL) {
+      if (keyscript_init(&keyscript, keyscript_filename, &scheduler,
+        &i8279) != 0) {
+        fprintf(stdout, "Error loading key script file: %s\n",
+          keyscript_filename);
+        return EXIT_FAILURE;
+      }
+    }
   }
 
+  if (script_filename != NULL) {
+    if (script_init(&script, script_filename,
+      serial_mode ? &serial : NULL, serial_mode ? NULL : &i8279) != 0) {
+      fprintf(stdout, "Error loading script file: %s\n", script_filename);
+      return EXIT_FAILURE;
+    }
+  }
+
+  debugger_init(&debugger_state, &mem);
+  if (profile.enabled) {
+    debugger_state.profile = &profile;
+  }
+  if (sampler_filename != NULL) {
+    if (sampler_init(&sampler, sampler_interval, &scheduler, &cpu,
+      &mem) != 0) {
+      fprintf(stdout, "Error setting up sampling every %llu cycles\n",
+        (unsigned long long)sampler_interval);
+      return EXIT_FAILURE;
+    }
+    debugger_state.sampler = &sampler;
+    atexit(sampler_at_exit);
+  }
+  if (debugger_files(&debugger_state, debugger_script, debugger_output) != 0) {
+    fprintf(stdout, "Error opening debugger script or output file: %s %s\n",
+      debugger_script != NULL ? debugger_script : "-",
+      debugger_output != NULL ? debugger_output : "-");
+    return EXIT_FAILURE;
+  }
+  pace_init(&pace, speed);
   i8085_reset(&cpu);
   while (1) {
-    i8085_execute(&cpu, &mem);
+    if (skip_loops && i8085_loop_start[mem_peek(&mem, cpu.pc)] &&
+      debugger_state.run_steps == 0 &&
+      ! debugger_breakpoint_range(&debugger_state, cpu.pc, I8085_LOOP_MAX)) {
+      /* Counted delay loops are skipped up to the next deadline, the
+       * opcode test keeps the deadline off the common path. */
+      i8085_skip_loop(&cpu, &mem, next_deadline(serial_mode));
+    }
+    pc = cpu.pc;
+    if (profile.enabled) {
+      profile_execute(&profile, &cpu, &mem);
+    } else {
+      i8085_execute(&cpu, &mem);
+    }
+
+    if (cpu.halt) {
+      /* Skip ahead to the next deadline instead of spinning. */
+      deadline = next_deadline(serial_mode);
+      if (deadline == UINT64_MAX) {
+        if (serial_mode && ! debugger_state.run) {
+          poll(NULL, 0, -1); /* Nothing can wake it, but the debugger. */
+        }
+      } else if (deadline > cpu.cycles) {
+        cpu.cycles = deadline;
+      }
+    }
 
     if (i8155_execute(&i8155, &cpu)) {
       i8085_trap(&cpu, &mem);
     }
 
+    if (cpu.cycles >= scheduler.next) {
+      scheduler_run(&scheduler, cpu.cycles);
+    }
+
+    if (cpu.cycles >= pace.next_cycles) {
+      pace_execute(&pace, cpu.cycles);
+    }
+
     if (serial_mode) {
-      if (cpu.pc == 0x0590) {
-        /* Monitor: Waiting for serial input. */
-        serial_input(&serial);
+      if (cpu.pc == 0x0590 || cpu.pc == 0x0592) {
+        /* Monitor: Waiting for serial input. Sleep until it arrives if
+         * nothing else can happen. */
+        serial_input(&serial, &cpu, host_idle() ? -1 : 0);
       }
       serial_execute(&serial, &cpu);
 
     } else {
       if (cpu.pc == 0x02E7 || cpu.halt || cpu.pc == 0x05F7) {
-        /* Monitor: Waiting for keyboard input, halted or delay finished. */
-        switch (i8279_keyboard_poll(&i8279)) {
-        case I8279_KEY_FIFO:
-          i8085_rst_55(&cpu, &mem);
-          break;
-        case I8279_KEY_RESET:
-          i8085_reset(&cpu);
-          break;
-        case I8279_KEY_VECT_INTR:
-          i8085_rst_75(&cpu, &mem);
-          break;
-        case I8279_KEY_QUIT:
+        /* Monitor: Waiting for keyboard input, halted or delay finished.
+         * Sleep until a key arrives if nothing else can happen. */
+        if (i8279_keyboard_poll(&i8279,
+          ((cpu.pc == 0x02E7 || cpu.halt) && keyboard_idle()) ? -1 : 0) ==
+          I8279_KEY_QUIT) {
           return EXIT_SUCCESS;
-          break;
-        case I8279_KEY_NONE:
-        default:
-          break;
         }
       }
     }
 
-    if (cpu.pc == debugger_breakpoint) {
+    if (script_filename != NULL) {
+      if (script_execute(&script, &cpu)) {
+        return (script.failed > 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+      }
+    }
+
+    if (debugger_breakpoint_hit(&debugger_state, cpu.pc) &&
+      debugger_breakpoint_check(&debugger_state, &cpu, &mem)) {
+      debugger_break = true;
+    }
+    if (debugger_state.watch_hit) {
+      debugger_state.watch_pc = pc;
+      debugger_break = true;
+    }
+    if (debugger_state.run && debugger_run_done(&debugger_state, &cpu, pc)) {
       debugger_break = true;
     }
 
     if (debugger_break) {
       if (serial_mode) {
-        serial_pause();
+        serial_pause(&serial);
       } else {
-        i8279_pause();
+        i8279_pause(&i8279);
       }
       if (panic_msg[0] != '\0') {
-        fprintf(stdout, "%s", panic_msg);
+        fprintf(debugger_state.out, "%s", panic_msg);
         panic_msg[0] = '\0';
       }
-      debugger_break = debugger(&cpu, &mem);
+      debugger_break = debugger(&debugger_state, &cpu, &mem);
       if (! debugger_break) {
+        pace_resync(&pace, cpu.cycles);
         if (serial_mode) {
-          serial_resume();
+          serial_resume(&serial);
         } else {
-          i8279_resume();
+          i8279_resume(&i8279);
         }
       }
     }
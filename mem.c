@@ -1,11 +1,20 @@
 #include "mem.h"
 #include <ctype.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <strings.h>
 
 #include "panic.h"
 
+/* Dump output is collected and written in blocks of this size. */
+#define MEM_DUMP_BUFFER 4096
+#define MEM_DUMP_LINE 80
+
+static const char mem_hex_digit[16] = "0123456789abcdef";
+
 
 
 void mem_init(mem_t *mem)
@@ -23,18 +32,25 @@ void mem_init(mem_t *mem)
   }
 
   mem->i8279_read = NULL;
+  mem->i8279_peek = NULL;
   mem->i8279_write = NULL;
   mem->i8279 = NULL;
+
+  for (i = 0; i < MEM_PAGES; i++) {
+    mem->watch[i] = 0;
+  }
+  mem->watch_hook = NULL;
+  mem->watch_cookie = NULL;
 }
 
 
 
-uint8_t mem_read(mem_t *mem, uint16_t address)
+static uint8_t mem_read_map(mem_t *mem, uint16_t address)
 {
   if (address < 0x1000) {
     return mem->rom[address];
   } else {
-    if (address == MEM_I8279_KEYBOARD_FIFO || address == MEM_I8279_STATUS) {
+    if ((address & MEM_I8279_MASK) == MEM_I8279_BASE) {
       if (mem->i8279_read != NULL && mem->i8279 != NULL) {
         return (mem->i8279_read)(mem->i8279, address);
       }
@@ -49,10 +65,10 @@ uint8_t mem_read(mem_t *mem, uint16_t address)
 
 
 
-void mem_write(mem_t *mem, uint16_t address, uint8_t value)
+static void mem_write_map(mem_t *mem, uint16_t address, uint8_t value)
 {
   if (address >= 0x1000) {
-    if (address == MEM_I8279_DISPLAY_DATA || address == MEM_I8279_COMMAND) {
+    if ((address & MEM_I8279_MASK) == MEM_I8279_BASE) {
       if (mem->i8279_write != NULL && mem->i8279 != NULL) {
         (mem->i8279_write)(mem->i8279, address, value);
       }
@@ -66,21 +82,164 @@ void mem_write(mem_t *mem, uint16_t address, uint8_t value)
 
 
 
+static uint8_t mem_read_watched(mem_t *mem, uint16_t address)
+{
+  uint8_t value;
+
+  value = mem_read_map(mem, address);
+  if (mem->watch_hook != NULL) {
+    (mem->watch_hook)(mem->watch_cookie, address, value, value, false);
+  }
+  return value;
+}
+
+
+
+static void mem_write_watched(mem_t *mem, uint16_t address, uint8_t value)
+{
+  uint8_t old;
+
+  old = mem_peek(mem, address);
+  mem_write_map(mem, address, value);
+  if (mem->watch_hook != NULL) {
+    (mem->watch_hook)(mem->watch_cookie, address, old, value, true);
+  }
+}
+
+
+
+uint8_t mem_peek(mem_t *mem, uint16_t address)
+{
+  /* Same map as mem_read(), but devices are never disturbed. */
+  if (address < 0x1000) {
+    return mem->rom[address];
+  } else if ((address & MEM_I8279_MASK) == MEM_I8279_BASE) {
+    if (mem->i8279_peek != NULL && mem->i8279 != NULL) {
+      return (mem->i8279_peek)(mem->i8279, address);
+    }
+  } else if (address >= 0x2000 && address <= 0x27FF) {
+    return mem->ram[address & 0xFF];
+  } else if (address >= 0x2800 && address <= 0x2FFF) {
+    return mem->exp[address & 0xFF];
+  }
+  return 0xFF;
+}
+
+
+
+int mem_poke(mem_t *mem, uint16_t address, uint8_t value)
+{
+  /* Loads go straight to ROM or RAM, never to devices or watch hooks. */
+  if (address < MEM_ROM_MAX) {
+    mem->rom[address] = value;
+  } else if (address >= 0x2000 && address <= 0x27FF) {
+    mem->ram[address & 0xFF] = value;
+  } else if (address >= 0x2800 && address <= 0x2FFF) {
+    mem->exp[address & 0xFF] = value;
+  } else {
+    return -1;
+  }
+  return 0;
+}
+
+
+
+uint16_t mem_canonical(uint16_t address)
+{
+  /* RAM and expansion RAM repeat every 256 bytes and the 8279 only
+   * decodes A8, so each mirror maps to its first address. */
+  if ((address & MEM_I8279_MASK) == MEM_I8279_BASE) {
+    return MEM_I8279_BASE | (address & MEM_I8279_CONTROL);
+  } else if (address >= 0x2000 && address <= 0x2FFF) {
+    return (address & 0xF800) | (address & 0xFF);
+  }
+  return address;
+}
+
+
+
+bool mem_range_aliased(uint16_t start, uint16_t end)
+{
+  uint32_t base;
+  uint32_t low;
+  uint32_t high;
+
+  /* RAM and expansion RAM are 256 bytes repeated over 2K each, so a
+   * range of more than 256 bytes in either would hit some bytes twice. */
+  for (base = 0x2000; base <= 0x2800; base += 0x800) {
+    low = (start > base) ? start : base;
+    high = (end < base + 0x7FF) ? end : base + 0x7FF;
+    if (low <= high && high - low >= 0x100) {
+      return true;
+    }
+  }
+  return false;
+}
+
+
+
+uint8_t mem_read(mem_t *mem, uint16_t address)
+{
+  if (mem->watch[address >> 8] & MEM_WATCH_READ) {
+    return mem_read_watched(mem, address);
+  }
+  return mem_read_map(mem, address);
+}
+
+
+
+void mem_write(mem_t *mem, uint16_t address, uint8_t value)
+{
+  if (mem->watch[address >> 8] & MEM_WATCH_WRITE) {
+    mem_write_watched(mem, address, value);
+    return;
+  }
+  mem_write_map(mem, address, value);
+}
+
+
+
 int mem_load_from_hex_file(mem_t *mem, const char *filename)
 {
   FILE *fh;
   char line[128];
+  int32_t owner[0x200];
   uint8_t byte_count;
   uint16_t address;
   uint8_t record_type;
   uint8_t data;
   int n;
+  int i;
 
   fh = fopen(filename, "r");
   if (fh == NULL) {
     return -1;
   }
 
+  /* Check all records before loading any, refusing files that put two
+   * different addresses onto the same byte of mirrored RAM. */
+  for (i = 0; i < 0x200; i++) {
+    owner[i] = -1;
+  }
+  while (fgets(line, sizeof(line), fh) != NULL) {
+    if (sscanf(line, ":%02hhx%04hx%02hhx",
+      &byte_count, &address, &record_type) != 3 || record_type != 0) {
+      continue;
+    }
+    for (; byte_count > 0; address++, byte_count--) {
+      if (address < 0x2000 || address > 0x2FFF) {
+        continue;
+      }
+      i = ((address & 0x800) >> 3) | (address & 0xFF);
+      if (owner[i] >= 0 && owner[i] != address) {
+        fclose(fh);
+        return -1;
+      }
+      owner[i] = address;
+    }
+  }
+  rewind(fh);
+
   while (fgets(line, sizeof(line), fh) != NULL) {
     if (sscanf(line, ":%02hhx%04hx%02hhx",
       &byte_count, &address, &record_type) != 3) {
@@ -97,10 +256,7 @@ int mem_load_from_hex_file(mem_t *mem, const char *filename)
     while (byte_count > 0) {
       sscanf(&line[n], "%02hhx", &data);
       n += 2;
-      if (address >= MEM_ROM_MAX) {
-        continue;
-      }
-      mem->rom[address] = data;
+      mem_poke(mem, address, data); /* Unmapped addresses are ignored. */
       address++;
       byte_count--;
     }
@@ -112,55 +268,197 @@ int mem_load_from_hex_file(mem_t *mem, const char *filename)
 
 
 
-static void mem_dump_16(FILE *fh, mem_t *mem, uint16_t start, uint16_t end)
+int mem_load_from_binary_file(mem_t *mem, const char *filename,
+  uint16_t address)
+{
+  FILE *fh;
+  uint8_t buffer[MEM_DUMP_BUFFER];
+  size_t n;
+  size_t i;
+  long size;
+  uint32_t end = address;
+
+  fh = fopen(filename, "rb");
+  if (fh == NULL) {
+    return -1;
+  }
+
+  /* Check the range first, a load must not wrap onto itself. */
+  if (fseek(fh, 0, SEEK_END) != 0 || (size = ftell(fh)) < 0) {
+    fclose(fh);
+    return -1;
+  }
+  rewind(fh);
+  if (size > 0 && (address + size - 1 > 0xFFFF ||
+      mem_range_aliased(address, address + size - 1))) {
+    fclose(fh);
+    return -1;
+  }
+
+  while ((n = fread(buffer, 1, sizeof(buffer), fh)) > 0) {
+    for (i = 0; i < n; i++) {
+      if (end > 0xFFFF || mem_poke(mem, end, buffer[i]) != 0) {
+        fclose(fh);
+        return -1; /* Runs outside of ROM or RAM. */
+      }
+      end++;
+    }
+  }
+
+  fclose(fh);
+  return 0;
+}
+
+
+
+int mem_save_to_binary_file(mem_t *mem, const char *filename,
+  uint16_t start, uint16_t end)
+{
+  FILE *fh;
+  uint8_t buffer[MEM_DUMP_BUFFER];
+  uint32_t address;
+  size_t n = 0;
+
+  if (mem_range_aliased(start, end)) {
+    return -1;
+  }
+
+  fh = fopen(filename, "wb");
+  if (fh == NULL) {
+    return -1;
+  }
+
+  for (address = start; address <= end; address++) {
+    buffer[n++] = mem_peek(mem, address);
+    if (n == sizeof(buffer)) {
+      fwrite(buffer, 1, n, fh);
+      n = 0;
+    }
+  }
+  fwrite(buffer, 1, n, fh);
+
+  fclose(fh);
+  return 0;
+}
+
+
+
+int mem_save_to_hex_file(mem_t *mem, const char *filename,
+  uint16_t start, uint16_t end)
 {
+  FILE *fh;
+  uint32_t address;
+  uint8_t byte_count;
+  uint8_t checksum;
+  uint8_t value;
   int i;
+
+  if (mem_range_aliased(start, end)) {
+    return -1;
+  }
+
+  fh = fopen(filename, "w");
+  if (fh == NULL) {
+    return -1;
+  }
+
+  /* Data records of up to 16 bytes, then the end of file record. */
+  for (address = start; address <= end; address += byte_count) {
+    byte_count = (end - address + 1 < 16) ? end - address + 1 : 16;
+    checksum = byte_count + (address >> 8) + (address & 0xFF);
+    fprintf(fh, ":%02X%04X00", byte_count, address);
+    for (i = 0; i < byte_count; i++) {
+      value = mem_peek(mem, address + i);
+      checksum += value;
+      fprintf(fh, "%02X", value);
+    }
+    fprintf(fh, "%02X\n", (uint8_t)-checksum);
+  }
+  fprintf(fh, ":00000001FF\n");
+
+  fclose(fh);
+  return 0;
+}
+
+
+
+bool mem_hex_filename(const char *filename)
+{
+  size_t len = strlen(filename);
+
+  return len >= 4 && strcasecmp(&filename[len - 4], ".hex") == 0;
+}
+
+
+
+static char *mem_dump_16(char *p, mem_t *mem, uint16_t start,
+  uint16_t end)
+{
+  int i;
+  uint16_t base;
   uint16_t address;
-  uint8_t value;
+  uint8_t value[16];
+
+  base = start & 0xFFF0;
+  for (i = 0; i < 16; i++) {
+    value[i] = mem_peek(mem, base + i);
+  }
 
-  fprintf(fh, "%04x   ", start & 0xFFF0);
+  *p++ = mem_hex_digit[base >> 12];
+  *p++ = mem_hex_digit[(base >> 8) & 0xF];
+  *p++ = mem_hex_digit[(base >> 4) & 0xF];
+  *p++ = '0';
+  *p++ = ' ';
+  *p++ = ' ';
+  *p++ = ' ';
 
   /* Hex */
   for (i = 0; i < 16; i++) {
-    address = (start & 0xFFF0) + i;
-    value = mem_read(mem, address);
+    address = base + i;
     if ((address >= start) && (address <= end)) {
-      fprintf(fh, "%02x ", value);
+      *p++ = mem_hex_digit[value[i] >> 4];
+      *p++ = mem_hex_digit[value[i] & 0xF];
     } else {
-      fprintf(fh, "   ");
+      *p++ = ' ';
+      *p++ = ' ';
     }
+    *p++ = ' ';
     if (i % 4 == 3) {
-      fprintf(fh, " ");
+      *p++ = ' ';
     }
   }
 
   /* Character */
   for (i = 0; i < 16; i++) {
-    address = (start & 0xFFF0) + i;
-    value = mem_read(mem, address);
+    address = base + i;
     if ((address >= start) && (address <= end)) {
-      if (isprint(value)) {
-        fprintf(fh, "%c", value);
-      } else {
-        fprintf(fh, ".");
-      }
+      *p++ = isprint(value[i]) ? value[i] : '.';
     } else {
-      fprintf(fh, " ");
+      *p++ = ' ';
     }
   }
 
-  fprintf(fh, "\n");
+  *p++ = '\n';
+  return p;
 }
 
 
 
 void mem_dump(FILE *fh, mem_t *mem, uint16_t start, uint16_t end)
 {
-  int i;
-  mem_dump_16(fh, mem, start, end);
+  char buffer[MEM_DUMP_BUFFER];
+  char *p = buffer;
+  uint32_t i;
+
+  p = mem_dump_16(p, mem, start, end);
   for (i = (start & 0xFFF0) + 16; i <= end; i += 16) {
-    mem_dump_16(fh, mem, i, end);
+    if (p - buffer > MEM_DUMP_BUFFER - MEM_DUMP_LINE) {
+      fwrite(buffer, 1, p - buffer, fh);
+      p = buffer;
+    }
+    p = mem_dump_16(p, mem, i, end);
   }
+  fwrite(buffer, 1, p - buffer, fh);
 }
 
 
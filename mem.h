@@ -1,33 +1,55 @@
 #ifndef _MEM_H
 #define _MEM_H
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 
 typedef uint8_t (*mem_read_hook_t)(void *, uint16_t);
 typedef void (*mem_write_hook_t)(void *, uint16_t, uint8_t);
+typedef void (*mem_watch_hook_t)(void *, uint16_t, uint8_t, uint8_t, bool);
 
 #define MEM_ROM_MAX 0x1000
 #define MEM_RAM_MAX 0x100
 
-#define MEM_I8279_KEYBOARD_FIFO 0x1800
-#define MEM_I8279_DISPLAY_DATA  0x1800
-#define MEM_I8279_STATUS        0x1900
-#define MEM_I8279_COMMAND       0x1900
+/* 8279 is selected by A15-A11 and A8 selects data or status/command. */
+#define MEM_I8279_MASK    0xF800
+#define MEM_I8279_BASE    0x1800
+#define MEM_I8279_CONTROL 0x0100
+
+/* Watch flags per 256 byte page, only flagged pages take the slow path. */
+#define MEM_PAGES       0x100
+#define MEM_WATCH_READ  0x1
+#define MEM_WATCH_WRITE 0x2
 
 typedef struct mem_s {
   uint8_t rom[MEM_ROM_MAX];
   uint8_t ram[MEM_RAM_MAX];
   uint8_t exp[MEM_RAM_MAX];
   mem_read_hook_t  i8279_read;
+  mem_read_hook_t  i8279_peek;
   mem_write_hook_t i8279_write;
   void *i8279;
+  uint8_t watch[MEM_PAGES];
+  mem_watch_hook_t watch_hook;
+  void *watch_cookie;
 } mem_t;
 
 void mem_init(mem_t *mem);
 uint8_t mem_read(mem_t *mem, uint16_t address);
+uint8_t mem_peek(mem_t *mem, uint16_t address);
+uint16_t mem_canonical(uint16_t address);
+bool mem_range_aliased(uint16_t start, uint16_t end);
+int mem_poke(mem_t *mem, uint16_t address, uint8_t value);
 void mem_write(mem_t *mem, uint16_t address, uint8_t value);
 int mem_load_from_hex_file(mem_t *mem, const char *filename);
+int mem_load_from_binary_file(mem_t *mem, const char *filename,
+  uint16_t address);
+int mem_save_to_hex_file(mem_t *mem, const char *filename,
+  uint16_t start, uint16_t end);
+int mem_save_to_binary_file(mem_t *mem, const char *filename,
+  uint16_t start, uint16_t end);
+bool mem_hex_filename(const char *filename);
 void mem_dump(FILE *fh, mem_t *mem, uint16_t start, uint16_t end);
 
 #endif /* _MEM_H */
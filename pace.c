@@ -0,0 +1,78 @@
+#include "pace.h"
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "i8085.h"
+
+#define PACE_NS_PER_SEC 1000000000LL
+
+
+
+static int64_t pace_timespec_ns(const struct timespec *ts)
+{
+  return ((int64_t)ts->tv_sec * PACE_NS_PER_SEC) + ts->tv_nsec;
+}
+
+
+
+void pace_init(pace_t *pace, double speed)
+{
+  memset(pace, 0, sizeof(pace_t));
+  pace->speed = speed;
+
+  if (speed <= 0.0) {
+    pace->next_cycles = UINT64_MAX; /* Unlimited, never called. */
+    return;
+  }
+
+  pace->slice_cycles = (I8085_CLOCK_HZ * speed * PACE_SLICE_NS) /
+    PACE_NS_PER_SEC;
+  if (pace->slice_cycles == 0) {
+    pace->slice_cycles = 1;
+  }
+  pace_resync(pace, 0);
+}
+
+
+
+void pace_resync(pace_t *pace, uint64_t cycles)
+{
+  if (pace->speed <= 0.0) {
+    return;
+  }
+  pace->base_cycles = cycles;
+  clock_gettime(CLOCK_MONOTONIC, &pace->base_time);
+  pace->next_cycles = cycles + pace->slice_cycles;
+}
+
+
+
+void pace_execute(pace_t *pace, uint64_t cycles)
+{
+  struct timespec now;
+  struct timespec target;
+  int64_t target_ns;
+
+  /* Target is computed from the base every time, so rounding and sleep
+   * overshoot never accumulate into drift. */
+  target_ns = pace_timespec_ns(&pace->base_time) +
+    (int64_t)((double)(cycles - pace->base_cycles) * PACE_NS_PER_SEC /
+    (I8085_CLOCK_HZ * pace->speed));
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (pace_timespec_ns(&now) - target_ns > PACE_MAX_LAG_NS) {
+    pace_resync(pace, cycles);
+    return;
+  }
+
+  target.tv_sec = target_ns / PACE_NS_PER_SEC;
+  target.tv_nsec = target_ns % PACE_NS_PER_SEC;
+  /* An interrupted sleep (SIGINT) just ends the slice early. */
+  clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, NULL);
+
+  pace->next_cycles = cycles + pace->slice_cycles;
+}
+
+
+
@@ -0,0 +1,25 @@
+#ifndef _PACE_H
+#define _PACE_H
+
+#include <stdint.h>
+#include <time.h>
+
+/* Wall clock time covered by one pacing slice. */
+#define PACE_SLICE_NS 1000000
+/* Falling further behind than this, e.g. after blocking on input, resyncs
+ * instead of running flat out to catch up. */
+#define PACE_MAX_LAG_NS 50000000
+
+typedef struct pace_s {
+  double speed; /* Multiple of the real CPU clock, 0 is unlimited. */
+  uint64_t slice_cycles;
+  uint64_t next_cycles;
+  uint64_t base_cycles;
+  struct timespec base_time;
+} pace_t;
+
+void pace_init(pace_t *pace, double speed);
+void pace_resync(pace_t *pace, uint64_t cycles);
+void pace_execute(pace_t *pace, uint64_t cycles);
+
+#endif /* _PACE_H */
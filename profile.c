@@ -0,0 +1,212 @@
+#include "profile.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "disasm.h"
+#include "i8085.h"
+#include "mem.h"
+
+
+
+void profile_init(profile_t *profile)
+{
+  memset(profile, 0, sizeof(profile_t));
+  profile->enabled = true;
+}
+
+
+
+static profile_arc_t *profile_arc(profile_t *profile, uint16_t site,
+  uint16_t callee)
+{
+  profile_arc_t *arc;
+  unsigned int i;
+
+  i = ((site * 31) + callee) & (PROFILE_ARCS_MAX - 1);
+  while (1) {
+    arc = &profile->arcs[i];
+    if (! arc->used) {
+      if (profile->arc_count >= PROFILE_ARCS_MAX - 1) {
+        return NULL; /* Keep one free slot so the probe ends. */
+      }
+      arc->used = true;
+      arc->site = site;
+      arc->callee = callee;
+      profile->arc_count++;
+      return arc;
+    }
+    if (arc->site == site && arc->callee == callee) {
+      return arc;
+    }
+    i = (i + 1) & (PROFILE_ARCS_MAX - 1);
+  }
+}
+
+
+
+static void profile_call(profile_t *profile, i8085_t *cpu, uint16_t site)
+{
+  profile_frame_t *frame;
+
+  if (profile->depth >= PROFILE_DEPTH_MAX) {
+    profile->overflows++;
+    return;
+  }
+  frame = &profile->stack[profile->depth++];
+  frame->function = cpu->pc;
+  frame->site = site;
+  frame->sp = cpu->sp;
+  frame->cycles = cpu->cycles;
+}
+
+
+
+static void profile_return(profile_t *profile, i8085_t *cpu)
+{
+  profile_frame_t *frame;
+  profile_arc_t *arc;
+
+  /* Frames whose return address is now below SP have been left, which
+   * also unwinds code that drops return addresses without a RET. */
+  while (profile->depth > 0 &&
+    profile->stack[profile->depth - 1].sp < cpu->sp) {
+    frame = &profile->stack[--profile->depth];
+    arc = profile_arc(profile, frame->site, frame->function);
+    if (arc != NULL) {
+      arc->calls++;
+      arc->cycles += cpu->cycles - frame->cycles;
+    }
+  }
+}
+
+
+
+void profile_execute(profile_t *profile, i8085_t *cpu, mem_t *mem)
+{
+  uint16_t pc;
+  uint16_t sp;
+  uint64_t cycles;
+  uint8_t opcode;
+
+  /* Take RST 5.5 here, so it is seen as a call from the interrupted PC.
+   * A halted CPU is already past its HLT, the call is made from there. */
+  if (cpu->rst55_line && cpu->mask.ie && ! cpu->mask.m55) {
+    pc = cpu->halt ? cpu->pc - 1 : cpu->pc;
+    i8085_rst_55(cpu, mem);
+    profile_call(profile, cpu, pc);
+  }
+
+  pc = cpu->pc;
+  sp = cpu->sp;
+  cycles = cpu->cycles;
+  opcode = mem_peek(mem, pc);
+
+  i8085_execute(cpu, mem);
+
+  profile->count[pc]++;
+  profile->cycles[pc] += cpu->cycles - cycles;
+  profile->function[pc] =
+    (profile->depth > 0) ? profile->stack[profile->depth - 1].function : 0;
+
+  if (opcode == 0xCD || (opcode & 0xC7) == 0xC4 || (opcode & 0xC7) == 0xC7) {
+    /* CALL, Ccc or RST, only when taken. */
+    if (cpu->sp == (uint16_t)(sp - 2)) {
+      profile_call(profile, cpu, pc);
+    }
+  } else if (opcode == 0xC9 || (opcode & 0xC7) == 0xC0) {
+    /* RET or Rcc, only when taken. */
+    if (cpu->sp == (uint16_t)(sp + 2)) {
+      profile_return(profile, cpu);
+    }
+  }
+}
+
+
+
+static void profile_function_name(FILE *fh, const char *key,
+  uint16_t address)
+{
+  const char *name;
+
+  name = disasm_symbol(address);
+  if (name != NULL) {
+    fprintf(fh, "%s=%s\n", key, name);
+  } else {
+    fprintf(fh, "%s=0x%04X\n", key, address);
+  }
+}
+
+
+
+int profile_write(profile_t *profile, const char *filename)
+{
+  FILE *fh;
+  static bool functions[PROFILE_ADDRESSES];
+  uint64_t total_cycles = 0;
+  uint64_t total_count = 0;
+  uint32_t function;
+  uint32_t address;
+  profile_arc_t *arc;
+  int i;
+
+  fh = fopen(filename, "w");
+  if (fh == NULL) {
+    return -1;
+  }
+
+  /* Each address is charged to the function it last ran in. */
+  memset(functions, 0, sizeof(functions));
+  for (address = 0; address < PROFILE_ADDRESSES; address++) {
+    if (profile->count[address] > 0) {
+      functions[profile->function[address]] = true;
+      total_cycles += profile->cycles[address];
+      total_count += profile->count[address];
+    }
+  }
+
+  fprintf(fh, "# callgrind format\n");
+  fprintf(fh, "version: 1\n");
+  fprintf(fh, "creator: sdk85emu\n");
+  fprintf(fh, "positions: instr\n");
+  fprintf(fh, "events: Cycles Instructions\n");
+  fprintf(fh, "summary: %llu %llu\n\n", (unsigned long long)total_cycles,
+    (unsigned long long)total_count);
+
+  for (function = 0; function < PROFILE_ADDRESSES; function++) {
+    if (! functions[function]) {
+      continue;
+    }
+    profile_function_name(fh, "fn", function);
+
+    for (address = 0; address < PROFILE_ADDRESSES; address++) {
+      if (profile->count[address] > 0 &&
+          profile->function[address] == function) {
+        fprintf(fh, "0x%04X %llu %llu\n", address,
+          (unsigned long long)profile->cycles[address],
+          (unsigned long long)profile->count[address]);
+      }
+    }
+
+    for (i = 0; i < PROFILE_ARCS_MAX; i++) {
+      arc = &profile->arcs[i];
+      if (! arc->used || arc->calls == 0 ||
+          profile->function[arc->site] != function) {
+        continue;
+      }
+      profile_function_name(fh, "cfn", arc->callee);
+      fprintf(fh, "calls=%llu 0x%04X\n", (unsigned long long)arc->calls,
+        arc->callee);
+      fprintf(fh, "0x%04X %llu\n", arc->site,
+        (unsigned long long)arc->cycles);
+    }
+    fprintf(fh, "\n");
+  }
+
+  fclose(fh);
+  return 0;
+}
+
+
+
@@ -0,0 +1,44 @@
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "i8085.h"
+#include "mem.h"
+
+#define PROFILE_ADDRESSES 0x10000
+#define PROFILE_DEPTH_MAX 256
+#define PROFILE_ARCS_MAX 4096 /* Power of two, used as a hash table. */
+
+typedef struct profile_frame_s {
+  uint16_t function;
+  uint16_t site;
+  uint16_t sp; /* Where the return address was pushed. */
+  uint64_t cycles; /* At entry. */
+} profile_frame_t;
+
+typedef struct profile_arc_s {
+  bool used;
+  uint16_t site;
+  uint16_t callee;
+  uint64_t calls;
+  uint64_t cycles; /* Inclusive. */
+} profile_arc_t;
+
+typedef struct profile_s {
+  bool enabled;
+  uint64_t count[PROFILE_ADDRESSES];
+  uint64_t cycles[PROFILE_ADDRESSES];
+  uint16_t function[PROFILE_ADDRESSES]; /* Entry of the running function. */
+  profile_frame_t stack[PROFILE_DEPTH_MAX];
+  int depth;
+  unsigned long overflows;
+  profile_arc_t arcs[PROFILE_ARCS_MAX];
+  int arc_count;
+} profile_t;
+
+void profile_init(profile_t *profile);
+void profile_execute(profile_t *profile, i8085_t *cpu, mem_t *mem);
+int profile_write(profile_t *profile, const char *filename);
+
+#endif /* _PROFILE_H */
@@ -0,0 +1,215 @@
+#include "sampler.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "disasm.h"
+#include "i8085.h"
+#include "mem.h"
+#include "scheduler.h"
+
+typedef struct sampler_stack_s {
+  uint16_t frame[SAMPLER_DEPTH + 1]; /* Outermost first. */
+  uint8_t depth;
+  uint64_t weight;
+} sampler_stack_t;
+
+
+
+static void sampler_walk(sampler_t *sampler, sampler_sample_t *sample)
+{
+  uint16_t address;
+  uint16_t ret;
+  uint16_t callee;
+  uint8_t opcode;
+  int i;
+
+  /* Words on the stack that follow a CALL or RST are taken as return
+   * addresses, anything else pushed in between is passed over. Stale
+   * words above the stack are kept out by requiring each called entry
+   * to be at or below the code it was found to be running. */
+  address = sample->sp;
+  for (i = 0; i < SAMPLER_SCAN && sample->depth < SAMPLER_DEPTH; i++) {
+    if (address > 0xFFFE) {
+      break;
+    }
+    ret = mem_peek(sampler->mem, address) |
+      (mem_peek(sampler->mem, address + 1) << 8);
+    address += 2;
+
+    opcode = mem_peek(sampler->mem, ret - 3);
+    if (opcode == 0xCD || (opcode & 0xC7) == 0xC4) {
+      callee = mem_peek(sampler->mem, ret - 2) |
+        (mem_peek(sampler->mem, ret - 1) << 8);
+    } else {
+      /* RST 7 is left out, 0xFF is also what erased or unmapped
+       * memory reads as. */
+      opcode = mem_peek(sampler->mem, ret - 1);
+      if ((opcode & 0xC7) != 0xC7 || opcode == 0xFF) {
+        continue;
+      }
+      callee = opcode & 0x38;
+    }
+    if (callee > sample->root) {
+      continue;
+    }
+    sample->callee[sample->depth++] = callee;
+    sample->root = ret;
+  }
+}
+
+
+
+static void sampler_decimate(sampler_t *sampler)
+{
+  unsigned int i;
+
+  /* Keep every other sample at twice the interval, so a full buffer
+   * still covers the whole run. */
+  for (i = 0; i < sampler->count / 2; i++) {
+    sampler->samples[i] = sampler->samples[i * 2];
+    sampler->samples[i].weight += sampler->samples[(i * 2) + 1].weight;
+  }
+  sampler->count /= 2;
+  sampler->interval *= 2;
+}
+
+
+
+static void sampler_event(void *sampler, uint64_t cycles)
+{
+  sampler_t *s = sampler;
+  sampler_sample_t *sample;
+
+  if (s->count >= SAMPLER_SAMPLES_MAX) {
+    sampler_decimate(s);
+  }
+
+  sample = &s->samples[s->count++];
+  sample->pc = s->cpu->pc;
+  sample->sp = s->cpu->sp;
+  sample->root = sample->pc;
+  sample->depth = 0;
+  /* A halt or skipped loop may have jumped over several intervals. */
+  sample->weight = (1 + ((cycles - s->cycles) / s->interval)) * s->interval;
+  sampler_walk(s, sample);
+
+  s->cycles += sample->weight;
+  scheduler_add_passive(s->scheduler, s->cycles, sampler_event, s);
+}
+
+
+
+int sampler_init(sampler_t *sampler, uint64_t interval,
+  scheduler_t *scheduler, i8085_t *cpu, mem_t *mem)
+{
+  memset(sampler, 0, sizeof(sampler_t));
+
+  if (interval == 0) {
+    return -1;
+  }
+  sampler->interval = interval;
+  sampler->cycles = cpu->cycles + interval;
+  sampler->scheduler = scheduler;
+  sampler->cpu = cpu;
+  sampler->mem = mem;
+
+  /* Passive, so sampling neither bounds fast-forwarding nor keeps the
+   * emulator from blocking on key input, the weights cover the gaps. */
+  return scheduler_add_passive(scheduler, sampler->cycles, sampler_event,
+    sampler);
+}
+
+
+
+static int sampler_stack_compare(const void *a, const void *b)
+{
+  const sampler_stack_t *sa = a;
+  const sampler_stack_t *sb = b;
+
+  if (sa->depth != sb->depth) {
+    return sa->depth - sb->depth;
+  }
+  return memcmp(sa->frame, sb->frame, (sa->depth + 1) * sizeof(uint16_t));
+}
+
+
+
+static void sampler_frame_name(FILE *fh, uint16_t address)
+{
+  const char *name;
+
+  name = disasm_symbol(address);
+  if (name != NULL) {
+    fprintf(fh, "%s", name);
+  } else {
+    fprintf(fh, "0x%04X", address);
+  }
+}
+
+
+
+int sampler_write(sampler_t *sampler, const char *filename)
+{
+  FILE *fh;
+  sampler_stack_t *stacks;
+  sampler_sample_t *sample;
+  unsigned int count = 0;
+  unsigned int i;
+  int j;
+
+  stacks = malloc(sizeof(sampler_stack_t) * (sampler->count + 1));
+  if (stacks == NULL) {
+    return -1;
+  }
+
+  fh = fopen(filename, "w");
+  if (fh == NULL) {
+    free(stacks);
+    return -1;
+  }
+
+  /* The outermost frame is where the walk ended, the rest are the
+   * functions called from there down to the one holding the PC. */
+  for (i = 0; i < sampler->count; i++) {
+    sample = &sampler->samples[i];
+    memset(&stacks[i], 0, sizeof(sampler_stack_t));
+    stacks[i].frame[0] = sample->root;
+    /* Entries come from call operands, the root is somewhere inside an
+     * unknown function, so it goes to the closest symbol below it. */
+    disasm_symbol_nearest(sample->root, &stacks[i].frame[0]);
+    stacks[i].depth = sample->depth;
+    for (j = 0; j < sample->depth; j++) {
+      stacks[i].frame[j + 1] = sample->callee[sample->depth - 1 - j];
+    }
+    stacks[i].weight = sample->weight;
+  }
+  qsort(stacks, sampler->count, sizeof(sampler_stack_t),
+    sampler_stack_compare);
+
+  for (i = 0; i < sampler->count; i++) {
+    if (count > 0 &&
+        sampler_stack_compare(&stacks[count - 1], &stacks[i]) == 0) {
+      stacks[count - 1].weight += stacks[i].weight;
+    } else {
+      stacks[count++] = stacks[i];
+    }
+  }
+
+  for (i = 0; i < count; i++) {
+    sampler_frame_name(fh, stacks[i].frame[0]);
+    for (j = 1; j <= stacks[i].depth; j++) {
+      fprintf(fh, ";");
+      sampler_frame_name(fh, stacks[i].frame[j]);
+    }
+    fprintf(fh, " %llu\n", (unsigned long long)stacks[i].weight);
+  }
+
+  fclose(fh);
+  free(stacks);
+  return 0;
+}
+
+
+
@@ -0,0 +1,36 @@
+#ifndef _SAMPLER_H
+#define _SAMPLER_H
+
+#include <stdint.h>
+#include "i8085.h"
+#include "mem.h"
+#include "scheduler.h"
+
+#define SAMPLER_SAMPLES_MAX 65536
+#define SAMPLER_DEPTH 4 /* Return addresses kept per sample. */
+#define SAMPLER_SCAN 8 /* Stack words looked at to find them. */
+
+typedef struct sampler_sample_s {
+  uint16_t pc;
+  uint16_t sp;
+  uint16_t root; /* PC, or the outermost return address found. */
+  uint16_t callee[SAMPLER_DEPTH]; /* Called entries, innermost first. */
+  uint8_t depth;
+  uint64_t weight; /* Cycles covered by this sample. */
+} sampler_sample_t;
+
+typedef struct sampler_s {
+  uint64_t interval;
+  uint64_t cycles; /* Of the next sample. */
+  sampler_sample_t samples[SAMPLER_SAMPLES_MAX];
+  unsigned int count;
+  scheduler_t *scheduler;
+  i8085_t *cpu;
+  mem_t *mem;
+} sampler_t;
+
+int sampler_init(sampler_t *sampler, uint64_t interval,
+  scheduler_t *scheduler, i8085_t *cpu, mem_t *mem);
+int sampler_write(sampler_t *sampler, const char *filename);
+
+#endif /* _SAMPLER_H */
@@ -0,0 +1,157 @@
+#include "scheduler.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+
+
+static bool scheduler_before(const scheduler_event_t *a,
+  const scheduler_event_t *b)
+{
+  /* Events at the same cycle run in the order they were added. */
+  if (a->cycles != b->cycles) {
+    return a->cycles < b->cycles;
+  }
+  return a->seq < b->seq;
+}
+
+
+
+static void scheduler_swap(scheduler_event_t *heap, unsigned int a,
+  unsigned int b)
+{
+  scheduler_event_t tmp;
+
+  tmp = heap[a];
+  heap[a] = heap[b];
+  heap[b] = tmp;
+}
+
+
+
+static void scheduler_remove_first(scheduler_t *scheduler)
+{
+  scheduler_event_t *heap = scheduler->heap;
+  unsigned int i;
+  unsigned int child;
+
+  scheduler->count--;
+  heap[0] = heap[scheduler->count];
+
+  /* Sift down. */
+  i = 0;
+  while (1) {
+    child = (i * 2) + 1;
+    if (child >= scheduler->count) {
+      break;
+    }
+    if (child + 1 < scheduler->count &&
+        scheduler_before(&heap[child + 1], &heap[child])) {
+      child++;
+    }
+    if (! scheduler_before(&heap[child], &heap[i])) {
+      break;
+    }
+    scheduler_swap(heap, i, child);
+    i = child;
+  }
+}
+
+
+
+static void scheduler_update(scheduler_t *scheduler)
+{
+  unsigned int i;
+
+  scheduler->next = SCHEDULER_NEVER;
+  if (scheduler->count > 0) {
+    scheduler->next = scheduler->heap[0].cycles;
+  }
+
+  /* Few events are ever queued, so a scan beats a second heap. */
+  scheduler->next_active = SCHEDULER_NEVER;
+  for (i = 0; i < scheduler->count; i++) {
+    if (! scheduler->heap[i].passive &&
+        scheduler->heap[i].cycles < scheduler->next_active) {
+      scheduler->next_active = scheduler->heap[i].cycles;
+    }
+  }
+}
+
+
+
+void scheduler_init(scheduler_t *scheduler)
+{
+  memset(scheduler, 0, sizeof(scheduler_t));
+  scheduler->next = SCHEDULER_NEVER;
+  scheduler->next_active = SCHEDULER_NEVER;
+}
+
+
+
+static int scheduler_insert(scheduler_t *scheduler, uint64_t cycles,
+  scheduler_func_t func, void *cookie, bool passive)
+{
+  scheduler_event_t *heap = scheduler->heap;
+  unsigned int i;
+  unsigned int parent;
+
+  if (scheduler->count >= SCHEDULER_EVENTS_MAX) {
+    return -1;
+  }
+
+  i = scheduler->count++;
+  heap[i].cycles = cycles;
+  heap[i].seq = scheduler->seq++;
+  heap[i].func = func;
+  heap[i].cookie = cookie;
+  heap[i].passive = passive;
+
+  /* Sift up. */
+  while (i > 0) {
+    parent = (i - 1) / 2;
+    if (! scheduler_before(&heap[i], &heap[parent])) {
+      break;
+    }
+    scheduler_swap(heap, i, parent);
+    i = parent;
+  }
+
+  scheduler_update(scheduler);
+  return 0;
+}
+
+
+
+int scheduler_add(scheduler_t *scheduler, uint64_t cycles,
+  scheduler_func_t func, void *cookie)
+{
+  return scheduler_insert(scheduler, cycles, func, cookie, false);
+}
+
+
+
+int scheduler_add_passive(scheduler_t *scheduler, uint64_t cycles,
+  scheduler_func_t func, void *cookie)
+{
+  return scheduler_insert(scheduler, cycles, func, cookie, true);
+}
+
+
+
+void scheduler_run(scheduler_t *scheduler, uint64_t cycles)
+{
+  scheduler_event_t event;
+
+  /* Events may add new events, including ones that are already due. */
+  while (scheduler->count > 0 && scheduler->heap[0].cycles <= cycles) {
+    event = scheduler->heap[0];
+    scheduler_remove_first(scheduler);
+    (event.func)(event.cookie, cycles);
+  }
+
+  scheduler_update(scheduler);
+}
+
+
+
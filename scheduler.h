@@ -0,0 +1,35 @@
+#ifndef _SCHEDULER_H
+#define _SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SCHEDULER_EVENTS_MAX 64
+#define SCHEDULER_NEVER UINT64_MAX
+
+typedef void (*scheduler_func_t)(void *, uint64_t);
+
+typedef struct scheduler_event_s {
+  uint64_t cycles;
+  uint64_t seq;
+  scheduler_func_t func;
+  void *cookie;
+  bool passive; /* Runs when due, but never counts as pending work. */
+} scheduler_event_t;
+
+typedef struct scheduler_s {
+  scheduler_event_t heap[SCHEDULER_EVENTS_MAX];
+  unsigned int count;
+  uint64_t seq;
+  uint64_t next; /* Cycles of the earliest event, SCHEDULER_NEVER if none. */
+  uint64_t next_active; /* Same, but ignoring passive events. */
+} scheduler_t;
+
+void scheduler_init(scheduler_t *scheduler);
+int scheduler_add(scheduler_t *scheduler, uint64_t cycles,
+  scheduler_func_t func, void *cookie);
+int scheduler_add_passive(scheduler_t *scheduler, uint64_t cycles,
+  scheduler_func_t func, void *cookie);
+void scheduler_run(scheduler_t *scheduler, uint64_t cycles);
+
+#endif /* _SCHEDULER_H */
@@ -0,0 +1,438 @@
+#define _GNU_SOURCE /* For memmem() */
+#include "script.h"
+#include <ctype.h>
+#include <fnmatch.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "i8085.h"
+#include "i8279.h"
+#include "serial.h"
+
+/* Default expect timeout is 10 seconds of emulated time. */
+#define SCRIPT_DEFAULT_TIMEOUT (I8085_CLOCK_HZ * 10ULL)
+
+/* Interval to retry sending when the serial input queue is full. */
+#define SCRIPT_SEND_RETRY_CYCLES 1000
+
+/* Interval to check if all keys have been taken by the monitor. */
+#define SCRIPT_KEY_RETRY_CYCLES 1000
+
+
+
+static void script_output_hook(void *script, uint8_t byte)
+{
+  script_t *s = script;
+
+  if (s->output_len >= SCRIPT_OUTPUT_MAX) {
+    /* Keep the most recent half, enough for any pattern. */
+    memmove(s->output, &s->output[SCRIPT_OUTPUT_MAX / 2],
+      SCRIPT_OUTPUT_MAX / 2);
+    s->output_len = SCRIPT_OUTPUT_MAX / 2;
+  }
+  s->output[s->output_len++] = byte;
+
+  if (s->state != SCRIPT_STATE_EXPECT) {
+    return;
+  }
+  if (s->output_len >= s->data_len &&
+      memcmp(&s->output[s->output_len - s->data_len],
+      s->data, s->data_len) == 0) {
+    s->matched = true;
+    s->output_len = 0; /* Consume everything up to the match. */
+    s->next_cycles = 0; /* Continue on next execute. */
+  }
+}
+
+
+
+static bool script_display_match(script_t *s)
+{
+  char text[I8279_TEXT_MAX];
+
+  /* Display patterns are shell wildcard patterns, e.g. "- 80*". */
+  i8279_display_text(s->i8279, text);
+  return fnmatch(s->data, text, 0) == 0;
+}
+
+
+
+static void script_display_hook(void *script, uint64_t cycles,
+  const uint8_t *display_ram)
+{
+  script_t *s = script;
+
+  (void)cycles;
+  (void)display_ram;
+
+  if (s->state == SCRIPT_STATE_EXPECT && script_display_match(s)) {
+    s->matched = true;
+    s->next_cycles = 0; /* Continue on next execute. */
+  }
+}
+
+
+
+static int script_parse_string(const char *in, char *out, size_t *len)
+{
+  size_t n = 0;
+  unsigned int hex;
+
+  /* Quoted string with C-style escapes: \r \n \t \\ \" \xHH */
+  if (*in != '"') {
+    return -1;
+  }
+  in++;
+  while (*in != '"') {
+    if (*in == '\0' || n >= SCRIPT_LINE_MAX - 1) {
+      return -1;
+    }
+    if (*in == '\\') {
+      in++;
+      switch (*in) {
+      case 'r':
+        out[n++] = '\r';
+        break;
+      case 'n':
+        out[n++] = '\n';
+        break;
+      case 't':
+        out[n++] = '\t';
+        break;
+      case 'x':
+        if (sscanf(in + 1, "%2x", &hex) != 1) {
+          return -1;
+        }
+        out[n++] = hex;
+        in += isxdigit(in[2]) ? 2 : 1;
+        break;
+      case '\0':
+        return -1;
+      default:
+        out[n++] = *in;
+        break;
+      }
+    } else {
+      out[n++] = *in;
+    }
+    in++;
+  }
+  out[n] = '\0';
+  *len = n;
+  return 0;
+}
+
+
+
+static void script_print_string(FILE *fh, const char *s, size_t len)
+{
+  size_t i;
+
+  for (i = 0; i < len; i++) {
+    if (s[i] == '\r') {
+      fprintf(fh, "\\r");
+    } else if (s[i] == '\n') {
+      fprintf(fh, "\\n");
+    } else if (s[i] == '"' || s[i] == '\\') {
+      fprintf(fh, "\\%c", s[i]);
+    } else if (isprint((unsigned char)s[i])) {
+      fprintf(fh, "%c", s[i]);
+    } else {
+      fprintf(fh, "\\x%02X", (uint8_t)s[i]);
+    }
+  }
+}
+
+
+
+static void script_fail(script_t *script, i8085_t *cpu, const char *reason)
+{
+  char text[I8279_TEXT_MAX];
+
+  fprintf(stdout, "FAIL %s:%d: %s after %llu cycles\n",
+    script->filename, script->line_no, reason,
+    (unsigned long long)(cpu->cycles - script->start_cycles));
+  if (script->i8279 != NULL) {
+    i8279_display_text(script->i8279, text);
+    fprintf(stdout, "  Display: \"%s\"\n", text);
+  } else {
+    fprintf(stdout, "  Recent output: \"");
+    script_print_string(stdout, script->output, script->output_len);
+    fprintf(stdout, "\"\n");
+  }
+  script->failed++;
+  script->state = SCRIPT_STATE_DONE;
+}
+
+
+
+static void script_command(script_t *script, i8085_t *cpu, char *line)
+{
+  char *command;
+  char *args;
+  char *match;
+  char text[I8279_TEXT_MAX];
+  unsigned long long value;
+  size_t i;
+
+  command = line;
+  while (isspace((unsigned char)*command)) {
+    command++;
+  }
+  if (*command == '\0' || *command == '#') {
+    return; /* Empty or comment. */
+  }
+
+  args = command;
+  while (*args != '\0' && ! isspace((unsigned char)*args)) {
+    args++;
+  }
+  if (*args != '\0') {
+    *args++ = '\0';
+  }
+  while (isspace((unsigned char)*args)) {
+    args++;
+  }
+  args[strcspn(args, "\r\n")] = '\0';
+
+  if (strcmp(command, "send") == 0) {
+    if (script->serial == NULL) {
+      script_fail(script, cpu, "send needs serial mode");
+      return;
+    }
+    if (script_parse_string(args, script->data, &script->data_len) != 0) {
+      script_fail(script, cpu, "invalid send string");
+      return;
+    }
+    script->data_pos = 0;
+    script->state = SCRIPT_STATE_SEND;
+
+  } else if (strcmp(command, "key") == 0) {
+    if (script->i8279 == NULL) {
+      script_fail(script, cpu, "key needs keyboard mode");
+      return;
+    }
+    if (script_parse_string(args, script->data, &script->data_len) != 0) {
+      script_fail(script, cpu, "invalid key string");
+      return;
+    }
+    /* Injected keys are taken from the end. */
+    for (i = script->data_len; i > 0; i--) {
+      i8279_keyboard_inject(script->i8279, script->data[i - 1]);
+    }
+    script->state = SCRIPT_STATE_KEY;
+
+  } else if (strcmp(command, "snapshot") == 0) {
+    if (script->i8279 == NULL) {
+      script_fail(script, cpu, "snapshot needs keyboard mode");
+      return;
+    }
+    i8279_display_text(script->i8279, text);
+    fprintf(stdout, "SNAPSHOT %s:%d: \"%s\" at %llu cycles\n",
+      script->filename, script->line_no, text,
+      (unsigned long long)cpu->cycles);
+
+  } else if (strcmp(command, "expect") == 0) {
+    if (script_parse_string(args, script->data, &script->data_len) != 0) {
+      script_fail(script, cpu, "invalid expect string");
+      return;
+    }
+    value = script->timeout;
+    args = strrchr(args, '"') + 1;
+    if (sscanf(args, "%llu", &value) != 1) {
+      value = script->timeout;
+    }
+    script->start_cycles = cpu->cycles;
+    script->deadline = cpu->cycles + value;
+    script->next_cycles = script->deadline;
+    script->matched = false;
+    script->state = SCRIPT_STATE_EXPECT;
+
+    if (script->i8279 != NULL) {
+      /* Display may already show it. */
+      if (script_display_match(script)) {
+        script->matched = true;
+        script->next_cycles = 0;
+      }
+      return;
+    }
+
+    /* Output may already have arrived, e.g. during a wait. */
+    match = memmem(script->output, script->output_len,
+      script->data, script->data_len);
+    if (match != NULL) {
+      script->output_len -= (match - script->output) + script->data_len;
+      memmove(script->output, match + script->data_len, script->output_len);
+      script->matched = true;
+      script->next_cycles = 0;
+    }
+
+  } else if (strcmp(command, "wait") == 0) {
+    if (sscanf(args, "%llu", &value) != 1) {
+      script_fail(script, cpu, "invalid wait cycles");
+      return;
+    }
+    script->next_cycles = cpu->cycles + value;
+    script->state = SCRIPT_STATE_WAIT;
+
+  } else if (strcmp(command, "timeout") == 0) {
+    if (sscanf(args, "%llu", &value) != 1) {
+      script_fail(script, cpu, "invalid timeout cycles");
+      return;
+    }
+    script->timeout = value;
+
+  } else {
+    script_fail(script, cpu, "unknown command");
+  }
+}
+
+
+
+static int script_check_mode(script_t *script)
+{
+  char line[SCRIPT_LINE_MAX];
+  char command[16];
+  int line_no = 0;
+  int result = 0;
+
+  /* Catch a script meant for the other mode before anything runs, e.g.
+   * a send/expect script started without -s. */
+  while (fgets(line, sizeof(line), script->fh) != NULL) {
+    line_no++;
+    if (sscanf(line, " %15s", command) != 1) {
+      continue;
+    }
+    if (strcmp(command, "send") == 0 && script->serial == NULL) {
+      fprintf(stdout, "Script %s:%d: send needs serial mode, use -s\n",
+        script->filename, line_no);
+      result = -1;
+      break;
+    }
+    if ((strcmp(command, "key") == 0 || strcmp(command, "snapshot") == 0) &&
+        script->i8279 == NULL) {
+      fprintf(stdout, "Script %s:%d: %s needs keyboard mode, omit -s\n",
+        script->filename, line_no, command);
+      result = -1;
+      break;
+    }
+  }
+  rewind(script->fh);
+  return result;
+}
+
+
+
+int script_init(script_t *script, const char *filename, serial_t *serial,
+  i8279_t *i8279)
+{
+  memset(script, 0, sizeof(script_t));
+
+  script->fh = fopen(filename, "r");
+  if (script->fh == NULL) {
+    return -1;
+  }
+  script->filename = filename;
+  script->timeout = SCRIPT_DEFAULT_TIMEOUT;
+  script->state = SCRIPT_STATE_RUN;
+
+  script->serial = serial;
+  if (serial != NULL) {
+    serial->output_hook = script_output_hook;
+    serial->output_cookie = script;
+  }
+
+  script->i8279 = i8279;
+  if (i8279 != NULL) {
+    i8279->display_hook = script_display_hook;
+    i8279->display_cookie = script;
+  }
+
+  if (script_check_mode(script) != 0) {
+    fclose(script->fh);
+    return -1;
+  }
+  return 0;
+}
+
+
+
+bool script_execute(script_t *script, i8085_t *cpu)
+{
+  char line[SCRIPT_LINE_MAX];
+  size_t n;
+
+  if (cpu->cycles < script->next_cycles) {
+    return false;
+  }
+
+  while (1) {
+    switch (script->state) {
+    case SCRIPT_STATE_RUN:
+      if (fgets(line, sizeof(line), script->fh) == NULL) {
+        script->state = SCRIPT_STATE_DONE;
+        break;
+      }
+      script->line_no++;
+      script_command(script, cpu, line);
+      break;
+
+    case SCRIPT_STATE_SEND:
+      n = serial_send(script->serial, &script->data[script->data_pos],
+        script->data_len - script->data_pos);
+      script->data_pos += n;
+      if (script->data_pos < script->data_len) {
+        script->next_cycles = cpu->cycles + SCRIPT_SEND_RETRY_CYCLES;
+        return false;
+      }
+      script->state = SCRIPT_STATE_RUN;
+      break;
+
+    case SCRIPT_STATE_KEY:
+      if (script->i8279->inject_size > 0) {
+        script->next_cycles = cpu->cycles + SCRIPT_KEY_RETRY_CYCLES;
+        return false;
+      }
+      script->state = SCRIPT_STATE_RUN;
+      break;
+
+    case SCRIPT_STATE_EXPECT:
+      if (script->matched) {
+        fprintf(stdout, "PASS %s:%d: expect \"", script->filename,
+          script->line_no);
+        script_print_string(stdout, script->data, script->data_len);
+        fprintf(stdout, "\" after %llu cycles\n",
+          (unsigned long long)(cpu->cycles - script->start_cycles));
+        script->passed++;
+        script->state = SCRIPT_STATE_RUN;
+      } else if (cpu->cycles >= script->deadline) {
+        script_fail(script, cpu, "expect timed out");
+      } else {
+        script->next_cycles = script->deadline;
+        return false;
+      }
+      break;
+
+    case SCRIPT_STATE_WAIT:
+      if (cpu->cycles < script->next_cycles) {
+        return false;
+      }
+      script->state = SCRIPT_STATE_RUN;
+      break;
+
+    case SCRIPT_STATE_DONE:
+    default:
+      fclose(script->fh);
+      fprintf(stdout, "Script %s: %d passed, %d failed, %llu cycles\n",
+        script->filename, script->passed, script->failed,
+        (unsigned long long)cpu->cycles);
+      return true;
+    }
+  }
+}
+
+
+
@@ -0,0 +1,48 @@
+#ifndef _SCRIPT_H
+#define _SCRIPT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "i8085.h"
+#include "i8279.h"
+#include "serial.h"
+
+#define SCRIPT_LINE_MAX 256
+#define SCRIPT_OUTPUT_MAX 4096
+
+typedef enum {
+  SCRIPT_STATE_RUN,
+  SCRIPT_STATE_SEND,
+  SCRIPT_STATE_KEY,
+  SCRIPT_STATE_EXPECT,
+  SCRIPT_STATE_WAIT,
+  SCRIPT_STATE_DONE,
+} script_state_t;
+
+typedef struct script_s {
+  FILE *fh;
+  const char *filename;
+  int line_no;
+  script_state_t state;
+  uint64_t next_cycles;
+  uint64_t start_cycles;
+  uint64_t deadline;
+  uint64_t timeout;
+  char data[SCRIPT_LINE_MAX];
+  size_t data_len;
+  size_t data_pos;
+  char output[SCRIPT_OUTPUT_MAX];
+  size_t output_len;
+  bool matched;
+  int passed;
+  int failed;
+  serial_t *serial;
+  i8279_t *i8279;
+} script_t;
+
+int script_init(script_t *script, const char *filename, serial_t *serial,
+  i8279_t *i8279);
+bool script_execute(script_t *script, i8085_t *cpu);
+
+#endif /* _SCRIPT_H */
@@ -1,10 +1,18 @@
+#define _GNU_SOURCE /* For pseudo-terminal functions. */
 #include "serial.h"
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <signal.h>
 #include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
 #include <termios.h>
 #include <unistd.h>
 
@@ -12,76 +20,598 @@
 
 
 
-/* Serial runs at 110 baud as used by the monitor.
+/* Serial runs at 110 baud as used by the monitor, but can be configured.
  * Output/Input bit changes every 1/110 = 0.0091 second.
- * 0.0091 seconds are 9100000 nanoseconds.
- * CPU uses 330 nanoseconds on one cycle.
- * This means the bit changes every 9100000 / 330 = 27575 cycles.
- * Collect 27 samples, once sample every 1000 cycles.
+ * CPU runs at 3.072 MHz, so one bit lasts 3072000 / 110 = 27927 cycles.
+ * Output is collected as 27 samples spread evenly over each bit.
+ * Input is not sampled, the SID line is instead calculated from the
+ * cycle count whenever the CPU executes RIM.
  */
 #define SERIAL_SAMPLE_LIMIT 27
-#define SERIAL_CYCLE_CATCHUP_SKIP 1000
 
-#define SERIAL_DATA_BITS 7
+/* Output is flushed in batches every 10ms of emulated time. */
+#define SERIAL_FLUSH_CYCLES (I8085_CLOCK_HZ / 100)
 
+/* Maximum time to wait for a stalled output when pausing or exiting. */
+#define SERIAL_DRAIN_TIMEOUT 1000
 
+static serial_t *serial_exit_serial = NULL;
 
-void serial_pause(void)
+
+
+static void serial_nonblock(int fd, bool enable)
+{
+  int flags;
+
+  flags = fcntl(fd, F_GETFL);
+  if (flags == -1) {
+    return;
+  }
+  if (enable) {
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  } else {
+    fcntl(fd, F_SETFL, flags & ~O_NONBLOCK);
+  }
+}
+
+
+
+static void serial_disconnect(serial_t *serial)
+{
+  if (serial->backend == SERIAL_BACKEND_UNIX) {
+    /* Drop the client and wait for the next one to connect. */
+    if (serial->input_fd != -1) {
+      close(serial->input_fd);
+    }
+    serial->input_fd = -1;
+    serial->output_fd = -1;
+  } else if (serial->backend != SERIAL_BACKEND_PTY) {
+    serial->input_eof = true;
+  }
+}
+
+
+
+static void serial_accept(serial_t *serial)
+{
+  int fd;
+
+  fd = accept(serial->listen_fd, NULL, NULL);
+  if (fd == -1) {
+    return;
+  }
+  if (serial->input_fd != -1) {
+    close(fd); /* Only one client at a time. */
+    return;
+  }
+  serial_nonblock(fd, true);
+  serial->input_fd = fd;
+  serial->output_fd = fd;
+}
+
+
+
+static void serial_fill(serial_t *serial)
+{
+  unsigned int head;
+  unsigned int tail;
+  struct iovec iov[2];
+  int iovcnt;
+  ssize_t n;
+
+  if (serial->input_fd == -1) {
+    return; /* Not connected. */
+  }
+
+  head = serial->input_queue_head;
+  tail = serial->input_queue_tail;
+  if (((head + 1) % SERIAL_INPUT_QUEUE_SIZE) == tail) {
+    return; /* Full */
+  }
+
+  /* Read directly into the free parts of the queue, wrapping included. */
+  if (head >= tail) {
+    iov[0].iov_base = &serial->input_queue[head];
+    iov[0].iov_len = SERIAL_INPUT_QUEUE_SIZE - head;
+    iov[1].iov_base = &serial->input_queue[0];
+    iov[1].iov_len = tail;
+    if (tail == 0) {
+      iov[0].iov_len--;
+      iovcnt = 1;
+    } else {
+      iov[1].iov_len--;
+      iovcnt = 2;
+    }
+  } else {
+    iov[0].iov_base = &serial->input_queue[head];
+    iov[0].iov_len = tail - head - 1;
+    iovcnt = 1;
+  }
+
+  n = readv(serial->input_fd, iov, iovcnt);
+  if (n == 0) {
+    serial_disconnect(serial);
+  } else if (n > 0) {
+    serial->input_queue_head = (head + n) % SERIAL_INPUT_QUEUE_SIZE;
+  } else if (errno != EAGAIN && errno != EINTR && errno != EIO) {
+    serial_disconnect(serial);
+  }
+}
+
+
+
+static void serial_flush(serial_t *serial)
+{
+  unsigned int head;
+  unsigned int tail;
+  struct iovec iov[2];
+  int iovcnt;
+  ssize_t n;
+
+  if (serial->output_fd == -1) {
+    return; /* Not connected, keep queued. */
+  }
+
+  head = serial->output_queue_head;
+  tail = serial->output_queue_tail;
+  if (head == tail) {
+    return;
+  }
+
+  /* Write directly from the used parts of the queue, wrapping included. */
+  iov[0].iov_base = &serial->output_queue[tail];
+  if (head > tail) {
+    iov[0].iov_len = head - tail;
+    iovcnt = 1;
+  } else {
+    iov[0].iov_len = SERIAL_OUTPUT_QUEUE_SIZE - tail;
+    iov[1].iov_base = &serial->output_queue[0];
+    iov[1].iov_len = head;
+    iovcnt = (head == 0) ? 1 : 2;
+  }
+
+  n = writev(serial->output_fd, iov, iovcnt);
+  if (n > 0) {
+    serial->output_queue_tail = (tail + n) % SERIAL_OUTPUT_QUEUE_SIZE;
+  } else if (n == -1 && errno == EPIPE) {
+    serial_disconnect(serial);
+  }
+  /* Otherwise stalled, try again later. */
+}
+
+
+
+static void serial_drain(serial_t *serial)
+{
+  struct pollfd pfd;
+  int n;
+
+  pfd.fd = serial->output_fd;
+  pfd.events = POLLOUT;
+
+  serial_flush(serial);
+  while (serial->output_queue_tail != serial->output_queue_head &&
+    serial->output_fd != -1) {
+    n = poll(&pfd, 1, SERIAL_DRAIN_TIMEOUT);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    } else if (n <= 0) {
+      return; /* Give up on a stalled output. */
+    }
+    serial_flush(serial);
+  }
+}
+
+
+
+static void serial_wait(serial_t *serial, int timeout)
+{
+  struct pollfd pfd[3];
+
+  /* Negative descriptors are ignored by poll(). */
+  pfd[0].fd = serial->input_fd;
+  pfd[0].events = POLLIN;
+  pfd[1].fd = -1;
+  pfd[1].events = POLLOUT;
+  pfd[2].fd = serial->listen_fd;
+  pfd[2].events = POLLIN;
+
+  if (serial->output_queue_tail != serial->output_queue_head) {
+    pfd[1].fd = serial->output_fd;
+  }
+
+  /* Relax the host CPU until input arrives, flushing output meanwhile. */
+  if (poll(pfd, 3, timeout) <= 0) {
+    return;
+  }
+
+  if (pfd[1].revents & (POLLOUT | POLLERR | POLLHUP)) {
+    serial_flush(serial);
+  }
+  if (pfd[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+    serial_fill(serial);
+  }
+  if (pfd[2].revents & POLLIN) {
+    serial_accept(serial);
+  }
+}
+
+
+
+static void serial_output(serial_t *serial, uint8_t byte)
+{
+  unsigned int head;
+
+  if (serial->output_hook != NULL) {
+    (serial->output_hook)(serial->output_cookie, byte);
+  }
+  if (serial->backend == SERIAL_BACKEND_NONE) {
+    return;
+  }
+
+  head = (serial->output_queue_head + 1) % SERIAL_OUTPUT_QUEUE_SIZE;
+  if (head == serial->output_queue_tail) {
+    serial_flush(serial);
+    if (head == serial->output_queue_tail) {
+      serial->output_overruns++; /* Drop instead of blocking the CPU. */
+      return;
+    }
+  }
+
+  serial->output_queue[serial->output_queue_head] = byte;
+  serial->output_queue_head = head;
+}
+
+
+
+void serial_pause(serial_t *serial)
 {
-  /* Restore canonical mode and echo. */
   struct termios ts;
-  tcgetattr(STDIN_FILENO, &ts);
-  ts.c_lflag |= ICANON | ECHO;
-  tcsetattr(STDIN_FILENO, TCSANOW, &ts);
+
+  serial_drain(serial);
+  if (serial->backend != SERIAL_BACKEND_STDIO) {
+    return; /* Console is not shared with the serial device. */
+  }
+  serial_nonblock(serial->input_fd, false);
+  serial_nonblock(serial->output_fd, false);
+
+  /* Restore canonical mode and echo. */
+  if (tcgetattr(serial->input_fd, &ts) == 0) {
+    ts.c_lflag |= ICANON | ECHO;
+    tcsetattr(serial->input_fd, TCSANOW, &ts);
+  }
 }
 
 
 
-void serial_resume(void)
+void serial_resume(serial_t *serial)
 {
+  struct termios ts;
+
+  if (serial->backend != SERIAL_BACKEND_STDIO) {
+    return;
+  }
+
   /* Turn off canonical mode and echo. */
+  if (tcgetattr(serial->input_fd, &ts) == 0) {
+    ts.c_lflag &= ~ICANON & ~ECHO;
+    tcsetattr(serial->input_fd, TCSANOW, &ts);
+  }
+
+  serial_nonblock(serial->input_fd, true);
+  serial_nonblock(serial->output_fd, true);
+}
+
+
+
+static void serial_exit(void)
+{
+  if (serial_exit_serial != NULL) {
+    serial_pause(serial_exit_serial);
+    if (serial_exit_serial->backend == SERIAL_BACKEND_UNIX) {
+      unlink(serial_exit_serial->path);
+    }
+  }
+}
+
+
+
+static int serial_open_pty(serial_t *serial)
+{
   struct termios ts;
-  tcgetattr(STDIN_FILENO, &ts);
-  ts.c_lflag &= ~ICANON & ~ECHO;
-  tcsetattr(STDIN_FILENO, TCSANOW, &ts);
+  char *name;
+  int fd;
+
+  fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd == -1) {
+    return -1;
+  }
+  if (grantpt(fd) != 0 || unlockpt(fd) != 0 ||
+      (name = ptsname(fd)) == NULL) {
+    close(fd);
+    return -1;
+  }
+  strncpy(serial->path, name, sizeof(serial->path) - 1);
+
+  /* Keep the slave open so the master never sees a hangup. */
+  serial->slave_fd = open(serial->path, O_RDWR | O_NOCTTY);
+  if (serial->slave_fd == -1) {
+    close(fd);
+    return -1;
+  }
+  if (tcgetattr(serial->slave_fd, &ts) == 0) {
+    cfmakeraw(&ts);
+    tcsetattr(serial->slave_fd, TCSANOW, &ts);
+  }
+
+  serial_nonblock(fd, true);
+  serial->input_fd = fd;
+  serial->output_fd = fd;
+  fprintf(stdout, "Serial device on PTY: %s\n", serial->path);
+  return 0;
+}
+
+
+
+static int serial_open_unix(serial_t *serial, const char *path)
+{
+  struct sockaddr_un addr;
+  int fd;
+
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    return -1;
+  }
+  memset(&addr, 0, sizeof(struct sockaddr_un));
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+  strncpy(serial->path, path, sizeof(serial->path) - 1);
+
+  fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd == -1) {
+    return -1;
+  }
+  unlink(path);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(struct sockaddr_un)) != 0 ||
+      listen(fd, 1) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  /* A disconnected client must not terminate the emulator. */
+  signal(SIGPIPE, SIG_IGN);
+
+  serial_nonblock(fd, true);
+  serial->listen_fd = fd;
+  return 0;
+}
+
+
+
+static int serial_open_file(serial_t *serial, const char *files)
+{
+  char input[256];
+  const char *output;
+  size_t len;
+
+  output = strchr(files, ',');
+  len = (output == NULL) ? strlen(files) : (size_t)(output - files);
+  if (len == 0 || len >= sizeof(input)) {
+    return -1;
+  }
+  memcpy(input, files, len);
+  input[len] = '\0';
+
+  serial->input_fd = open(input, O_RDONLY | O_NONBLOCK);
+  if (serial->input_fd == -1) {
+    return -1;
+  }
+
+  if (output != NULL) {
+    serial->output_fd = open(output + 1, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (serial->output_fd == -1) {
+      close(serial->input_fd);
+      return -1;
+    }
+    serial_nonblock(serial->output_fd, true);
+  } else {
+    serial->output_fd = STDOUT_FILENO;
+    serial_nonblock(serial->output_fd, true);
+  }
+  return 0;
+}
+
+
+
+static int serial_open(serial_t *serial, const char *device)
+{
+  serial->listen_fd = -1;
+  serial->slave_fd = -1;
+  serial->input_fd = -1;
+  serial->output_fd = -1;
+
+  /* Device is "stdio", "pty", "unix:PATH", "file:INPUT[,OUTPUT]" or
+   * "none" where all input comes from serial_send() and output is only
+   * passed to the output hook. */
+  if (device != NULL && strcmp(device, "none") == 0) {
+    serial->backend = SERIAL_BACKEND_NONE;
+    return 0;
+
+  } else if (device == NULL || strcmp(device, "stdio") == 0) {
+    serial->backend = SERIAL_BACKEND_STDIO;
+    serial->input_fd = STDIN_FILENO;
+    serial->output_fd = STDOUT_FILENO;
+    return 0;
+
+  } else if (strcmp(device, "pty") == 0) {
+    serial->backend = SERIAL_BACKEND_PTY;
+    return serial_open_pty(serial);
+
+  } else if (strncmp(device, "unix:", 5) == 0) {
+    serial->backend = SERIAL_BACKEND_UNIX;
+    return serial_open_unix(serial, &device[5]);
+
+  } else if (strncmp(device, "file:", 5) == 0) {
+    serial->backend = SERIAL_BACKEND_FILE;
+    return serial_open_file(serial, &device[5]);
+  }
+
+  return -1;
 }
 
 
 
-void serial_init(serial_t *serial)
+static bool serial_sid_read(void *serial, uint64_t cycles)
+{
+  uint64_t bit;
+
+  if (cycles < ((serial_t *)serial)->input_frame_start ||
+      cycles >= ((serial_t *)serial)->input_frame_end) {
+    return true; /* Idle line is marking. */
+  }
+
+  bit = (cycles - ((serial_t *)serial)->input_frame_start) /
+    ((serial_t *)serial)->bit_cycles;
+  return (((serial_t *)serial)->input_frame >> bit) & 1;
+}
+
+
+
+static int serial_frame_bits(serial_t *serial)
+{
+  return 1 + serial->data_bits + (serial->parity == 'N' ? 0 : 1) +
+    serial->stop_bits;
+}
+
+
+
+int serial_init(serial_t *serial, i8085_t *cpu, int baud_rate,
+  const char *frame, const char *device)
 {
   memset(serial, 0, sizeof(serial_t));
   serial->output_state = SERIAL_STATE_IDLE;
-  serial->input_state = SERIAL_STATE_IDLE;
 
-  atexit(serial_pause);
-  serial_resume();
+  /* Frame format as data bits, parity and stop bits, e.g. "7N1". */
+  if (baud_rate <= 0 || baud_rate > I8085_CLOCK_HZ ||
+      strlen(frame) != 3) {
+    return -1;
+  }
+  serial->baud_rate = baud_rate;
+  serial->data_bits = frame[0] - '0';
+  serial->parity = toupper(frame[1]);
+  serial->stop_bits = frame[2] - '0';
+  if (serial->data_bits < 5 || serial->data_bits > 8 ||
+      (serial->parity != 'N' && serial->parity != 'E' &&
+       serial->parity != 'O') ||
+      serial->stop_bits < 1 || serial->stop_bits > 2) {
+    return -1;
+  }
+
+  serial->bit_cycles = I8085_CLOCK_HZ / baud_rate;
+  serial->sample_cycles = serial->bit_cycles / SERIAL_SAMPLE_LIMIT;
+  if (serial->sample_cycles == 0) {
+    serial->sample_cycles = 1;
+  }
 
-  /* Make stdout unbuffered. */
+  /* Keep stdout unbuffered for the debugger, serial output uses write(). */
   setvbuf(stdout, NULL, _IONBF, 0);
+
+  if (serial_open(serial, device) != 0) {
+    return -1;
+  }
+
+  cpu->sid = serial;
+  cpu->sid_read = serial_sid_read;
+
+  serial_exit_serial = serial;
+  atexit(serial_exit);
+  serial_resume(serial);
+
+  return 0;
 }
 
 
 
-void serial_input(serial_t *serial)
+void serial_input(serial_t *serial, i8085_t *cpu, int timeout)
 {
-  int c;
+  bool waited = false;
+  uint8_t c;
+  uint16_t frame;
+  int parity;
+  int i;
+
+  if (cpu->cycles < serial->input_frame_end) {
+    return; /* Previous frame still being shifted in. */
+  }
 
-  c = fgetc(stdin);
-  if (c == EOF) {
-    exit(EXIT_SUCCESS);
+  serial_fill(serial);
+  while (serial->input_queue_head == serial->input_queue_tail) {
+    if (serial->backend == SERIAL_BACKEND_NONE) {
+      return; /* Nothing to wait for, try again later. */
+    }
+    if (serial->input_eof) {
+      serial_drain(serial);
+      exit(EXIT_SUCCESS);
+    }
+    if (waited && timeout >= 0) {
+      return; /* Nothing yet, the CPU has other work to do. */
+    }
+    serial_flush(serial);
+    serial_wait(serial, timeout);
+    waited = true;
   }
 
+  c = serial->input_queue[serial->input_queue_tail];
+  serial->input_queue_tail =
+    (serial->input_queue_tail + 1) % SERIAL_INPUT_QUEUE_SIZE;
+
   if (c == '\n') {
     /* Convert LF to CR as needed by the monitor for commands. */
     c = '\r';
   }
 
-  if (serial->input_state == SERIAL_STATE_IDLE) {
-    serial->input_byte = c;
-    serial->input_sample_no = 0;
-    serial->input_state = SERIAL_STATE_START_BIT;
+  /* Build the whole frame: start bit, data bits, parity and stop bits. */
+  frame = 0xFFFE;
+  parity = 0;
+  for (i = 0; i < serial->data_bits; i++) {
+    if (((c >> i) & 1) == 0) {
+      frame &= ~(1 << (i + 1));
+    } else {
+      parity ^= 1;
+    }
   }
+  if ((serial->parity == 'E' && parity == 1) ||
+      (serial->parity == 'O' && parity == 0)) {
+    parity = 1;
+  } else {
+    parity = 0;
+  }
+  if (serial->parity != 'N' && parity == 0) {
+    frame &= ~(1 << (serial->data_bits + 1));
+  }
+
+  /* Start the next frame now, SID is then derived from the cycle count. */
+  serial->input_frame = frame;
+  serial->input_frame_start = cpu->cycles;
+  serial->input_frame_end = cpu->cycles +
+    (serial->bit_cycles * serial_frame_bits(serial));
+}
+
+
+
+size_t serial_send(serial_t *serial, const char *data, size_t len)
+{
+  unsigned int head;
+  size_t n;
+
+  for (n = 0; n < len; n++) {
+    head = (serial->input_queue_head + 1) % SERIAL_INPUT_QUEUE_SIZE;
+    if (head == serial->input_queue_tail) {
+      break; /* Full */
+    }
+    serial->input_queue[serial->input_queue_head] = data[n];
+    serial->input_queue_head = head;
+  }
+  return n;
 }
 
 
@@ -92,7 +622,25 @@ void serial_execute(serial_t *serial, i8085_t *cpu)
   if (cpu->cycles < serial->catchup_cycles) {
     return;
   }
-  serial->catchup_cycles += SERIAL_CYCLE_CATCHUP_SKIP;
+  serial->catchup_cycles += serial->sample_cycles;
+  if (serial->output_state == SERIAL_STATE_IDLE &&
+      cpu->cycles > serial->catchup_cycles) {
+    /* Skipped ahead, e.g. while halted, the idle line needs no samples.
+     * Whole samples are skipped, so the grid keeps its phase and a start
+     * bit is seen at the same cycle with or without fast-forwarding. */
+    serial->catchup_cycles += (((cpu->cycles - serial->catchup_cycles) /
+      serial->sample_cycles) + 1) * serial->sample_cycles;
+  }
+
+  /* Batched flush of output and opportunistic read of input. */
+  if (cpu->cycles >= serial->flush_cycles) {
+    serial->flush_cycles = cpu->cycles + SERIAL_FLUSH_CYCLES;
+    serial_flush(serial);
+    serial_fill(serial);
+    if (serial->listen_fd != -1 && serial->input_fd == -1) {
+      serial_accept(serial);
+    }
+  }
 
   /* Output */
   switch (serial->output_state) {
@@ -124,16 +672,33 @@ void serial_execute(serial_t *serial, i8085_t *cpu)
       serial->output_sample_no = 0;
       serial->output_samples = 0;
       serial->output_data_bit++;
-      if (serial->output_data_bit >= SERIAL_DATA_BITS) {
-        serial->output_state = SERIAL_STATE_STOP_BIT;
+      if (serial->output_data_bit >= serial->data_bits) {
+        if (serial->parity == 'N') {
+          serial->output_state = SERIAL_STATE_STOP_BIT;
+        } else {
+          serial->output_state = SERIAL_STATE_PARITY_BIT;
+        }
       }
     }
     break;
 
+  case SERIAL_STATE_PARITY_BIT:
+    /* Parity is not checked. */
+    serial->output_sample_no++;
+    if (serial->output_sample_no >= SERIAL_SAMPLE_LIMIT) {
+      serial->output_sample_no = 0;
+      serial->output_state = SERIAL_STATE_STOP_BIT;
+    }
+    break;
+
   case SERIAL_STATE_STOP_BIT:
     serial->output_sample_no++;
     if (serial->output_sample_no >= SERIAL_SAMPLE_LIMIT) {
-      fputc(serial->output_byte, stdout);
+      serial_output(serial, serial->output_byte);
+      if (((serial->output_queue_head - serial->output_queue_tail) %
+        SERIAL_OUTPUT_QUEUE_SIZE) >= (SERIAL_OUTPUT_QUEUE_SIZE / 2)) {
+        serial_flush(serial);
+      }
       serial->output_state = SERIAL_STATE_IDLE;
     }
     break;
@@ -141,43 +706,19 @@ void serial_execute(serial_t *serial, i8085_t *cpu)
   default:
     break;
   }
+}
 
-  /* Input */
-  switch (serial->input_state) {
-  case SERIAL_STATE_START_BIT:
-    cpu->mask.sid = false;
-    serial->input_sample_no++;
-    if (serial->input_sample_no >= SERIAL_SAMPLE_LIMIT) {
-      serial->input_sample_no = 0;
-      serial->input_data_bit = 0;
-      serial->input_state = SERIAL_STATE_DATA_BIT;
-    }
-    break;
-
-  case SERIAL_STATE_DATA_BIT:
-    cpu->mask.sid = (serial->input_byte >> serial->input_data_bit) & 1;
-    serial->input_sample_no++;
-    if (serial->input_sample_no >= SERIAL_SAMPLE_LIMIT) {
-      serial->input_sample_no = 0;
-      serial->input_data_bit++;
-      if (serial->input_data_bit >= SERIAL_DATA_BITS) {
-        serial->input_state = SERIAL_STATE_STOP_BIT;
-      }
-    }
-    break;
 
-  case SERIAL_STATE_STOP_BIT:
-    cpu->mask.sid = true;
-    serial->input_sample_no++;
-    if (serial->input_sample_no >= SERIAL_SAMPLE_LIMIT) {
-      serial->input_state = SERIAL_STATE_IDLE;
-    }
-    break;
 
-  case SERIAL_STATE_IDLE:
-  default:
-    break;
+uint64_t serial_deadline(serial_t *serial, i8085_t *cpu)
+{
+  if (serial->output_state != SERIAL_STATE_IDLE || cpu->sod) {
+    return serial->catchup_cycles; /* Next sample of the output frame. */
+  }
+  if (serial->output_queue_tail != serial->output_queue_head) {
+    return serial->flush_cycles;
   }
+  return UINT64_MAX;
 }
 
 
@@ -2,33 +2,76 @@
 #define _SERIAL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "i8085.h"
 
+#define SERIAL_INPUT_QUEUE_SIZE 256
+#define SERIAL_OUTPUT_QUEUE_SIZE 4096
+
+#define SERIAL_DEFAULT_BAUD_RATE 110
+#define SERIAL_DEFAULT_FRAME "7N1"
+
+typedef void (*serial_output_hook_t)(void *, uint8_t);
+
+typedef enum {
+  SERIAL_BACKEND_NONE,
+  SERIAL_BACKEND_STDIO,
+  SERIAL_BACKEND_PTY,
+  SERIAL_BACKEND_UNIX,
+  SERIAL_BACKEND_FILE,
+} serial_backend_t;
+
 typedef enum {
   SERIAL_STATE_IDLE,
   SERIAL_STATE_START_BIT,
   SERIAL_STATE_DATA_BIT,
+  SERIAL_STATE_PARITY_BIT,
   SERIAL_STATE_STOP_BIT,
 } serial_state_t;
 
 typedef struct serial_s {
+  int baud_rate;
+  int data_bits;
+  char parity;
+  int stop_bits;
+  uint64_t bit_cycles;
+  uint64_t sample_cycles;
   uint64_t catchup_cycles;
+  uint64_t flush_cycles;
+  serial_backend_t backend;
+  char path[108];
+  int listen_fd;
+  int slave_fd;
+  int input_fd;
+  int output_fd;
+  bool input_eof;
   serial_state_t output_state;
   int output_data_bit;
   int output_sample_no;
   int output_samples;
   uint8_t output_byte;
-  serial_state_t input_state;
-  int input_data_bit;
-  int input_sample_no;
-  uint8_t input_byte;
+  uint8_t output_queue[SERIAL_OUTPUT_QUEUE_SIZE];
+  unsigned int output_queue_head;
+  unsigned int output_queue_tail;
+  unsigned long output_overruns;
+  uint8_t input_queue[SERIAL_INPUT_QUEUE_SIZE];
+  unsigned int input_queue_head;
+  unsigned int input_queue_tail;
+  uint16_t input_frame;
+  uint64_t input_frame_start;
+  uint64_t input_frame_end;
+  serial_output_hook_t output_hook;
+  void *output_cookie;
 } serial_t;
 
-void serial_pause(void);
-void serial_resume(void);
-void serial_init(serial_t *serial);
-void serial_input(serial_t *serial);
+void serial_pause(serial_t *serial);
+void serial_resume(serial_t *serial);
+int serial_init(serial_t *serial, i8085_t *cpu, int baud_rate,
+  const char *frame, const char *device);
+void serial_input(serial_t *serial, i8085_t *cpu, int timeout);
+size_t serial_send(serial_t *serial, const char *data, size_t len);
 void serial_execute(serial_t *serial, i8085_t *cpu);
+uint64_t serial_deadline(serial_t *serial, i8085_t *cpu);
 
 #endif /* _SERIAL_H */